@@ -0,0 +1,111 @@
+// Sprites per second through the BatchRenderer at 1k, 100k and 1M quads
+// per frame, with textures cycled from a small set.
+//
+//   batch_bench [--frames N] [--textures N] [--headless]
+#include "BatchRenderer.h"
+#include "GLContext.h"
+#include "GLDebug.h"
+#include "GLDeletionQueue.h"
+#include "GLStateCache.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Sprite
+    {
+        float x, y, size;
+        uint32_t color;
+        unsigned int texture;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 20;
+    unsigned int textureCount = 8;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--textures") == 0)
+            textureCount = (unsigned int)std::atoi(argv[++i]);
+    }
+
+    GLContextDesc desc;
+    desc.width = 256;
+    desc.height = 256;
+    desc.title = "batch_bench";
+    desc.visible = false;
+    desc.vsync = false;
+    std::unique_ptr<GLContext> context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+    if (!context || !context->LoadGL())
+        return -1;
+
+    GLStateCache& state = GLStateCache::Get();
+    std::vector<unsigned int> textures(textureCount);
+    if (textureCount)
+        GLCall(glGenTextures((int)textureCount, textures.data()));
+    for (unsigned int i = 0; i < textureCount; i++)
+    {
+        const unsigned char texel[4] = {(unsigned char)(i * 37), (unsigned char)(255 - i * 23), 128, 255};
+        state.BindTexture(0, GL_TEXTURE_2D, textures[i]);
+        state.ActiveTexture(0);
+        GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel));
+        GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    }
+
+    {
+        BatchRenderer batch;
+        if (!batch.IsValid())
+            return -1;
+
+        std::cout << frames << " frames, " << textureCount << " textures\n" << std::fixed;
+        const unsigned int spriteCounts[] = {1000, 100000, 1000000};
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+        for (unsigned int count : spriteCounts)
+        {
+            std::vector<Sprite> sprites(count);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                sprites[i] = {position(random), position(random), 0.01f,
+                              BatchRenderer::PackColor(0.5f, 0.8f, 1.0f, 1.0f),
+                              textureCount ? textures[i % textureCount] : 0};
+            }
+
+            batch.ResetStats();
+            auto start = Clock::now();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                GLCall(glClear(GL_COLOR_BUFFER_BIT));
+                batch.Begin();
+                for (const Sprite& sprite : sprites)
+                    batch.DrawQuad(sprite.x, sprite.y, sprite.size, sprite.size, sprite.color, sprite.texture);
+                batch.End();
+                glFinish();
+                GLDeletionQueue::Get().EndFrame();
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            const BatchRenderer::Stats& stats = batch.GetStats();
+            std::cout << std::setw(8) << count << " sprites : " << std::setprecision(2)
+                      << (double)count * frames / seconds / 1e6 << " M sprites/s, "
+                      << std::setprecision(3) << seconds * 1000.0 / frames << " ms/frame, "
+                      << stats.batches / frames << " batches/frame" << std::endl;
+        }
+        batch.Report(std::cout);
+    }
+
+    for (unsigned int texture : textures)
+        GLDeletionQueue::Get().Delete(GLDeletionQueue::TEXTURE, texture);
+    GLDeletionQueue::Get().Flush();
+    return 0;
+}
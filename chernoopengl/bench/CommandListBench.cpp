@@ -0,0 +1,183 @@
+// Frame preparation recorded into CommandLists serially and on the
+// WorkerPool, then replayed on the context thread, against issuing the same
+// GL calls directly. Each object does some per-frame math before its draw,
+// standing in for culling and transform work.
+//
+//   command_list_bench [--objects N] [--frames N] [--headless]
+#include "CommandList.h"
+#include "GLContext.h"
+#include "GLDebug.h"
+#include "GLDeletionQueue.h"
+#include "GLStateCache.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Vertex
+    {
+        float position[2];
+    };
+}
+
+VERTEX_LAYOUT(Vertex, VERTEX_ATTRIBUTE(Vertex, position))
+
+namespace
+{
+    const char* VERTEX_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) in vec2 position;\n"
+        "uniform vec4 u_Transform;\n"
+        "void main() { gl_Position = vec4(position * u_Transform.z + u_Transform.xy, 0.0, 1.0); }\n";
+    const char* FRAGMENT_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) out vec4 color;\n"
+        "void main() { color = vec4(1.0); }\n";
+
+    unsigned int CompileProgram()
+    {
+        unsigned int program = glCreateProgram();
+        const char* sources[] = {VERTEX_SHADER, FRAGMENT_SHADER};
+        const unsigned int types[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+        for (int i = 0; i < 2; i++)
+        {
+            unsigned int shader = glCreateShader(types[i]);
+            GLCall(glShaderSource(shader, 1, &sources[i], nullptr));
+            GLCall(glCompileShader(shader));
+            GLCall(glAttachShader(program, shader));
+            GLCall(glDeleteShader(shader));
+        }
+        GLCall(glLinkProgram(program));
+        return program;
+    }
+
+    // Orbit of object i at time t; deliberately not free.
+    void Transform(unsigned int i, float t, float out[4])
+    {
+        float x = 0.0f, y = 0.0f;
+        for (int k = 1; k <= 8; k++)
+        {
+            x += std::sin(t * k + i * 0.37f) / (k * 8.0f);
+            y += std::cos(t * k + i * 0.61f) / (k * 8.0f);
+        }
+        out[0] = x;
+        out[1] = y;
+        out[2] = 0.01f;
+        out[3] = 1.0f;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int objectCount = 50000;
+    int frames = 50;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--objects") == 0)
+            objectCount = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[++i]);
+    }
+
+    GLContextDesc desc;
+    desc.width = 64;
+    desc.height = 64;
+    desc.title = "command_list_bench";
+    desc.visible = false;
+    desc.vsync = false;
+    std::unique_ptr<GLContext> context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+    if (!context || !context->LoadGL())
+        return -1;
+
+    unsigned int program = CompileProgram();
+    int transformLocation = glGetUniformLocation(program, "u_Transform");
+    {
+        const Vertex vertices[] = {{{-0.5f, -0.5f}}, {{0.5f, -0.5f}}, {{0.5f, 0.5f}}, {{-0.5f, 0.5f}}};
+        const unsigned int indices[] = {0, 1, 2, 2, 3, 0};
+        VertexArray va;
+        VertexBuffer vb(vertices, sizeof(vertices));
+        va.AddBuffer<Vertex>(vb);
+        IndexBuffer ib(indices, 6);
+        unsigned int vertexArray = va.GetRendererID();
+
+        auto record = [&](CommandList& list, size_t begin, size_t end, float t) {
+            list.UseProgram(program);
+            list.BindVertexArray(vertexArray);
+            for (size_t i = begin; i < end; i++)
+            {
+                float transform[4];
+                Transform((unsigned int)i, t, transform);
+                list.Uniform4f(transformLocation, transform[0], transform[1], transform[2], transform[3]);
+                list.DrawElements(ib.GetCount(), ib.GetType(), 0);
+            }
+        };
+
+        std::cout << objectCount << " objects, " << frames << " frames, " << WorkerPool::Get().GetThreadCount()
+                  << " threads\n" << std::fixed << std::setprecision(3);
+
+        auto time = [&](const char* name, auto&& frame) {
+            double prepareMs = 0.0, totalMs = 0.0;
+            for (int f = 0; f < frames; f++)
+            {
+                GLCall(glClear(GL_COLOR_BUFFER_BIT));
+                auto start = Clock::now();
+                double prepare = frame((float)f * 0.016f);
+                totalMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                prepareMs += prepare;
+                glFinish();
+            }
+            std::cout << std::setw(10) << name << " : " << totalMs / frames << " ms/frame, of which "
+                      << prepareMs / frames << " ms off the GL thread's critical path" << std::endl;
+        };
+
+        time("direct", [&](float t) {
+            GLStateCache& state = GLStateCache::Get();
+            state.UseProgram(program);
+            state.BindVertexArray(vertexArray);
+            for (unsigned int i = 0; i < objectCount; i++)
+            {
+                float transform[4];
+                Transform(i, t, transform);
+                GLCall(glUniform4f(transformLocation, transform[0], transform[1], transform[2], transform[3]));
+                GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+            }
+            return 0.0;
+        });
+
+        CommandList serial;
+        time("serial", [&](float t) {
+            auto start = Clock::now();
+            serial.Clear();
+            record(serial, 0, objectCount, t);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            serial.Execute();
+            return ms;
+        });
+
+        ParallelCommandRecorder recorder;
+        time("parallel", [&](float t) {
+            recorder.Record(objectCount, 1024, [&](CommandList& list, size_t begin, size_t end) {
+                record(list, begin, end, t);
+            });
+            recorder.Execute();
+            return recorder.GetStats().recordMs;
+        });
+        recorder.Report(std::cout);
+    }
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::PROGRAM, program);
+    GLDeletionQueue::Get().Flush();
+    return 0;
+}
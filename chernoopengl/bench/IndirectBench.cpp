@@ -0,0 +1,172 @@
+// CPU cost per frame of drawing N arena-backed meshes one call each versus
+// through an IndirectDrawList, with the 3.3 fallback loop and with
+// glMultiDrawElementsIndirect where available.
+//
+//   indirect_bench [--meshes N] [--frames N] [--headless]
+#include "BufferArena.h"
+#include "GLContext.h"
+#include "GLDebug.h"
+#include "GLDeletionQueue.h"
+#include "GLStateCache.h"
+#include "IndexBuffer.h"
+#include "IndirectDrawList.h"
+#include "VertexArrayCache.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Vertex
+    {
+        float position[2];
+    };
+}
+
+VERTEX_LAYOUT(Vertex, VERTEX_ATTRIBUTE(Vertex, position))
+
+namespace
+{
+    const char* VERTEX_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) in vec4 position;\n"
+        "void main() { gl_Position = position; }\n";
+    const char* FRAGMENT_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) out vec4 color;\n"
+        "void main() { color = vec4(1.0); }\n";
+
+    unsigned int CompileProgram()
+    {
+        unsigned int program = glCreateProgram();
+        const char* sources[] = {VERTEX_SHADER, FRAGMENT_SHADER};
+        const unsigned int types[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+        for (int i = 0; i < 2; i++)
+        {
+            unsigned int shader = glCreateShader(types[i]);
+            GLCall(glShaderSource(shader, 1, &sources[i], nullptr));
+            GLCall(glCompileShader(shader));
+            GLCall(glAttachShader(program, shader));
+            GLCall(glDeleteShader(shader));
+        }
+        GLCall(glLinkProgram(program));
+        return program;
+    }
+
+    struct Mesh
+    {
+        VertexBuffer vb;
+        IndexBuffer ib;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int meshCount = 10000;
+    int frames = 100;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--meshes") == 0)
+            meshCount = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[++i]);
+    }
+
+    GLContextDesc desc;
+    desc.width = 64;
+    desc.height = 64;
+    desc.title = "indirect_bench";
+    desc.visible = false;
+    desc.vsync = false;
+    std::unique_ptr<GLContext> context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+    if (!context || !context->LoadGL())
+        return -1;
+
+    GLStateCache& state = GLStateCache::Get();
+    unsigned int program = CompileProgram();
+    state.UseProgram(program);
+
+    // The arena index uploads need a VAO to bind to in a core profile.
+    unsigned int setupVao;
+    GLCall(glGenVertexArrays(1, &setupVao));
+    state.BindVertexArray(setupVao);
+    // GL objects below are queued for deletion when the block ends.
+    {
+        BufferArena vertexArena;
+        BufferArena indexArena;
+        const unsigned int indices[] = {0, 1, 2, 2, 3, 0};
+        std::vector<Mesh> meshes;
+        meshes.reserve(meshCount);
+        for (unsigned int i = 0; i < meshCount; i++)
+        {
+            float x = (float)(i % 100) * 0.02f - 1.0f;
+            float y = (float)(i / 100 % 100) * 0.02f - 1.0f;
+            Vertex vertices[4] = {{{x, y}}, {{x + 0.01f, y}}, {{x + 0.01f, y + 0.01f}}, {{x, y + 0.01f}}};
+            meshes.push_back({VertexBuffer(vertexArena, vertices, sizeof(vertices), sizeof(Vertex)),
+                              IndexBuffer(indexArena, indices, 6)});
+        }
+
+        std::cout << meshCount << " meshes, " << frames << " frames, " << WorkerPool::Get().GetThreadCount()
+                  << " build threads\n" << std::fixed << std::setprecision(3);
+
+        auto time = [&](const char* name, auto&& frame)
+        {
+            auto start = Clock::now();
+            for (int i = 0; i < frames; i++)
+            {
+                GLCall(glClear(GL_COLOR_BUFFER_BIT));
+                frame();
+                glFinish();
+                GLDeletionQueue::Get().EndFrame();
+            }
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / frames;
+            std::cout << std::setw(14) << name << " : " << ms << " ms/frame" << std::endl;
+        };
+
+        time("per-mesh", [&]
+        {
+            for (const Mesh& mesh : meshes)
+            {
+                VertexArrayCache::Get().Bind<Vertex>(mesh.vb, &mesh.ib);
+                GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, mesh.ib.GetCount(), mesh.ib.GetType(), mesh.ib.GetOffset(),
+                                                (int)mesh.vb.GetBaseVertex(sizeof(Vertex))));
+            }
+        });
+
+        for (bool multiDraw : {false, true})
+        {
+            IndirectDrawList list(sizeof(Vertex), multiDraw);
+            if (multiDraw && !list.UsesMultiDraw())
+            {
+                std::cout << "glMultiDrawElementsIndirect unsupported" << std::endl;
+                break;
+            }
+            time(multiDraw ? "multi-draw" : "3.3 fallback", [&]
+            {
+                list.Clear();
+                for (const Mesh& mesh : meshes)
+                    list.Add(mesh.vb, mesh.ib);
+                list.Build();
+                list.Submit<Vertex>();
+            });
+            list.Report(std::cout);
+        }
+
+        VertexArrayCache::Get().Clear();
+        meshes.clear();
+    }
+    state.BindVertexArray(0);
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::VERTEX_ARRAY, setupVao);
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::PROGRAM, program);
+    GLDeletionQueue::Get().Flush();
+    return 0;
+}
@@ -0,0 +1,222 @@
+// Draws N small meshes in two vertex formats, each mesh in its own vertex
+// buffer, first with one VertexArray per mesh and then through the
+// VertexArrayCache, and reports VAOs created, VAO/buffer binds issued and
+// CPU time per frame.
+//
+//   vao_cache_bench [--meshes N] [--frames N] [--headless]
+#include "GLContext.h"
+#include "GLDebug.h"
+#include "GLDeletionQueue.h"
+#include "GLStateCache.h"
+#include "Renderer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexArrayCache.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct PlainVertex
+    {
+        float position[2];
+    };
+
+    struct ColorVertex
+    {
+        float position[2];
+        unsigned char color[4];
+    };
+}
+
+VERTEX_LAYOUT(PlainVertex, VERTEX_ATTRIBUTE(PlainVertex, position))
+VERTEX_LAYOUT(ColorVertex, VERTEX_ATTRIBUTE(ColorVertex, position), VERTEX_ATTRIBUTE(ColorVertex, color))
+
+namespace
+{
+    const char* VERTEX_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) in vec4 position;\n"
+        "void main() { gl_Position = position; }\n";
+    const char* FRAGMENT_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) out vec4 color;\n"
+        "void main() { color = vec4(1.0); }\n";
+
+    unsigned int CompileProgram()
+    {
+        unsigned int program = glCreateProgram();
+        const char* sources[] = {VERTEX_SHADER, FRAGMENT_SHADER};
+        const unsigned int types[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+        for (int i = 0; i < 2; i++)
+        {
+            unsigned int shader = glCreateShader(types[i]);
+            GLCall(glShaderSource(shader, 1, &sources[i], nullptr));
+            GLCall(glCompileShader(shader));
+            GLCall(glAttachShader(program, shader));
+            GLCall(glDeleteShader(shader));
+        }
+        GLCall(glLinkProgram(program));
+        return program;
+    }
+
+    struct Mesh
+    {
+        VertexBuffer vb;
+        bool colored;
+    };
+
+    template<typename Vertex>
+    VertexBuffer MakeQuad(float x, float y)
+    {
+        Vertex vertices[4] = {};
+        const float corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+        for (int i = 0; i < 4; i++)
+        {
+            vertices[i].position[0] = x + corners[i][0] * 0.01f;
+            vertices[i].position[1] = y + corners[i][1] * 0.01f;
+        }
+        return VertexBuffer(vertices, sizeof(vertices));
+    }
+
+    struct Result
+    {
+        unsigned int vertexArrays;
+        unsigned long long vertexArrayBinds;
+        unsigned long long bufferBinds;
+        double frameMs;
+    };
+
+    void Print(const char* name, const Result& result)
+    {
+        std::cout << std::setw(10) << name << " : " << std::setw(6) << result.vertexArrays << " VAOs, "
+                  << std::setw(8) << result.vertexArrayBinds << " VAO binds/frame, "
+                  << std::setw(8) << result.bufferBinds << " buffer binds/frame, "
+                  << result.frameMs << " ms/frame" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int meshCount = 10000;
+    int frames = 100;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--meshes") == 0)
+            meshCount = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[++i]);
+    }
+
+    GLContextDesc desc;
+    desc.width = 64;
+    desc.height = 64;
+    desc.title = "vao_cache_bench";
+    desc.visible = false;
+    desc.vsync = false;
+    std::unique_ptr<GLContext> context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+    if (!context || !context->LoadGL())
+        return -1;
+
+    GLStateCache& state = GLStateCache::Get();
+    unsigned int program = CompileProgram();
+    state.UseProgram(program);
+
+    // The index buffer needs a VAO to bind to in a core profile.
+    unsigned int setupVao;
+    GLCall(glGenVertexArrays(1, &setupVao));
+    state.BindVertexArray(setupVao);
+    // GL objects below are queued for deletion when the block ends.
+    {
+        const unsigned int indices[] = {0, 1, 2, 2, 3, 0};
+        IndexBuffer ib(indices, 6);
+
+        std::vector<Mesh> meshes;
+        meshes.reserve(meshCount);
+        for (unsigned int i = 0; i < meshCount; i++)
+        {
+            float x = (float)(i % 100) * 0.02f - 1.0f;
+            float y = (float)(i / 100 % 100) * 0.02f - 1.0f;
+            bool colored = i % 2 != 0;
+            meshes.push_back({colored ? MakeQuad<ColorVertex>(x, y) : MakeQuad<PlainVertex>(x, y), colored});
+        }
+
+        auto run = [&](auto&& bind, auto&& vertexArrayCount)
+        {
+            state.ResetStats();
+            auto start = Clock::now();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                GLCall(glClear(GL_COLOR_BUFFER_BIT));
+                for (unsigned int i = 0; i < meshCount; i++)
+                {
+                    bind(i);
+                    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+                }
+                glFinish();
+            }
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            const GLStateCache::Stats& stats = state.GetStats();
+            return Result{vertexArrayCount(),
+                          stats.issued[GLStateCache::VERTEX_ARRAY] / frames,
+                          stats.issued[GLStateCache::BUFFER] / frames,
+                          ms / frames};
+        };
+
+        std::cout << meshCount << " meshes in 2 formats, " << frames << " frames\n";
+        std::cout << std::fixed << std::setprecision(3);
+
+        {
+            std::vector<VertexArray> vertexArrays(meshCount);
+            for (unsigned int i = 0; i < meshCount; i++)
+            {
+                VertexArray& va = vertexArrays[i];
+                if (meshes[i].colored)
+                    va.AddBuffer<ColorVertex>(meshes[i].vb);
+                else
+                    va.AddBuffer<PlainVertex>(meshes[i].vb);
+                ib.Bind();
+            }
+            Result result = run([&](unsigned int i) { vertexArrays[i].Bind(); },
+                                [&] { return meshCount; });
+            Print("per-mesh", result);
+        }
+
+        VertexArrayCache& cache = VertexArrayCache::Get();
+        // Warm up so the VAO creation is not part of the timing.
+        for (const Mesh& mesh : meshes)
+        {
+            if (mesh.colored)
+                cache.Bind<ColorVertex>(mesh.vb, &ib);
+            else
+                cache.Bind<PlainVertex>(mesh.vb, &ib);
+        }
+        cache.ResetStats();
+        Result result = run([&](unsigned int i)
+                            {
+                                if (meshes[i].colored)
+                                    cache.Bind<ColorVertex>(meshes[i].vb, &ib);
+                                else
+                                    cache.Bind<PlainVertex>(meshes[i].vb, &ib);
+                            },
+                            [&] { return cache.GetVertexArrayCount(); });
+        Print("cache", result);
+        cache.Report(std::cout);
+
+        cache.Clear();
+    }
+    state.BindVertexArray(0);
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::VERTEX_ARRAY, setupVao);
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::PROGRAM, program);
+    GLDeletionQueue::Get().Flush();
+    return 0;
+}
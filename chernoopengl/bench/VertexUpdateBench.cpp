@@ -0,0 +1,108 @@
+// CPU cost of VertexBuffer::FlushUpdates per strategy with 1%, 10% and
+// 100% of a dynamic buffer dirtied in scattered 64-byte writes each frame.
+//
+//   vertex_update_bench [--buffer-kb N] [--frames N] [--headless]
+#include "GLContext.h"
+#include "GLDebug.h"
+#include "GLDeletionQueue.h"
+#include "VertexBuffer.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr unsigned int WRITE_SIZE = 64;
+
+    const char* StrategyName(VertexBuffer::UpdateStrategy strategy)
+    {
+        switch (strategy)
+        {
+            case VertexBuffer::UpdateStrategy::AUTO: return "auto";
+            case VertexBuffer::UpdateStrategy::SUB_DATA: return "subdata";
+            case VertexBuffer::UpdateStrategy::ORPHAN: return "orphan";
+            case VertexBuffer::UpdateStrategy::MAP_UNSYNCHRONIZED: return "map-unsync";
+        }
+        return "?";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int bufferKb = 4096;
+    int frames = 100;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--buffer-kb") == 0)
+            bufferKb = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[++i]);
+    }
+
+    GLContextDesc desc;
+    desc.width = 64;
+    desc.height = 64;
+    desc.title = "vertex_update_bench";
+    desc.visible = false;
+    desc.vsync = false;
+    std::unique_ptr<GLContext> context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+    if (!context || !context->LoadGL())
+        return -1;
+
+    unsigned int size = bufferKb * 1024;
+    unsigned int slots = size / WRITE_SIZE;
+    std::vector<unsigned char> chunk(WRITE_SIZE, 0x5a);
+    std::mt19937 random(1234);
+
+    const VertexBuffer::UpdateStrategy strategies[] = {
+        VertexBuffer::UpdateStrategy::SUB_DATA, VertexBuffer::UpdateStrategy::ORPHAN,
+        VertexBuffer::UpdateStrategy::MAP_UNSYNCHRONIZED, VertexBuffer::UpdateStrategy::AUTO
+    };
+    const unsigned int dirtyPercents[] = {1, 10, 100};
+
+    std::cout << bufferKb << " KiB buffer, " << WRITE_SIZE << "-byte writes, " << frames << " frames\n";
+    std::cout << std::fixed << std::setprecision(3);
+    for (unsigned int percent : dirtyPercents)
+    {
+        unsigned int writes = slots * percent / 100;
+        for (VertexBuffer::UpdateStrategy strategy : strategies)
+        {
+            VertexBuffer vb(nullptr, size, GL_DYNAMIC_DRAW);
+            double flushMs = 0.0;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                if (percent == 100)
+                {
+                    for (unsigned int slot = 0; slot < slots; slot++)
+                        vb.Update(slot * WRITE_SIZE, chunk.data(), WRITE_SIZE);
+                }
+                else
+                {
+                    for (unsigned int i = 0; i < writes; i++)
+                        vb.Update((random() % slots) * WRITE_SIZE, chunk.data(), WRITE_SIZE);
+                }
+
+                auto start = Clock::now();
+                vb.FlushUpdates(strategy);
+                flushMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                // Nothing draws from the buffer, so the unsynchronized map
+                // never races the GPU; finishing keeps frames independent.
+                glFinish();
+            }
+            const VertexBuffer::UpdateStats& stats = vb.GetUpdateStats();
+            std::cout << std::setw(4) << percent << "% " << std::setw(11) << StrategyName(strategy)
+                      << " : " << flushMs / frames << " ms/flush, "
+                      << stats.ranges / frames << " ranges, "
+                      << stats.bytes / frames / 1024 << " KiB uploaded" << std::endl;
+        }
+    }
+    GLDeletionQueue::Get().Flush();
+    return 0;
+}
@@ -2,16 +2,20 @@
 #version 330 core 
 
 layout(location = 0) in vec4 position;
+layout(location = 1) in vec3 offsetScale;
 
 void main()
 {
-    gl_Position = position; 
+    gl_Position = vec4(position.xy * offsetScale.z + offsetScale.xy, 0.0, 1.0);
 };
 
 #shader fragment
 #version 330 core 
 
-uniform vec4 u_Color;
+layout(std140) uniform FrameUniforms
+{
+    vec4 u_Color;
+};
 
 layout(location = 0) out vec4 color;
 
@@ -0,0 +1,278 @@
+#include "BatchRenderer.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr unsigned int VERTICES_PER_QUAD = 4;
+    constexpr unsigned int INDICES_PER_QUAD = 6;
+    constexpr unsigned int REGION_SIZE = BatchRenderer::MAX_QUADS * VERTICES_PER_QUAD * sizeof(BatchVertex);
+
+    const char* VERTEX_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) in vec2 position;\n"
+        "layout(location = 1) in vec4 color;\n"
+        "layout(location = 2) in vec2 uv;\n"
+        "layout(location = 3) in float slot;\n"
+        "uniform mat4 u_ViewProjection;\n"
+        "out vec4 v_Color;\n"
+        "out vec2 v_UV;\n"
+        "flat out int v_Slot;\n"
+        "void main()\n"
+        "{\n"
+        "    v_Color = color;\n"
+        "    v_UV = uv;\n"
+        "    v_Slot = int(slot + 0.5);\n"
+        "    gl_Position = u_ViewProjection * vec4(position, 0.0, 1.0);\n"
+        "}\n";
+
+    // GLSL 3.30 only indexes sampler arrays with constants, hence the switch.
+    std::string FragmentShader()
+    {
+        std::string source =
+            "#version 330 core\n"
+            "uniform sampler2D u_Textures[" + std::to_string(BatchRenderer::MAX_TEXTURE_SLOTS) + "];\n"
+            "in vec4 v_Color;\n"
+            "in vec2 v_UV;\n"
+            "flat in int v_Slot;\n"
+            "layout(location = 0) out vec4 color;\n"
+            "void main()\n"
+            "{\n"
+            "    vec4 texel;\n"
+            "    switch (v_Slot)\n"
+            "    {\n";
+        for (unsigned int slot = 0; slot < BatchRenderer::MAX_TEXTURE_SLOTS; slot++)
+        {
+            std::string n = std::to_string(slot);
+            source += "        case " + n + ": texel = texture(u_Textures[" + n + "], v_UV); break;\n";
+        }
+        source +=
+            "        default: texel = vec4(1.0); break;\n"
+            "    }\n"
+            "    color = texel * v_Color;\n"
+            "}\n";
+        return source;
+    }
+
+    unsigned int CompileShader(unsigned int type, const char* source)
+    {
+        unsigned int id = glCreateShader(type);
+        GLCall(glShaderSource(id, 1, &source, nullptr));
+        GLCall(glCompileShader(id));
+
+        int result;
+        GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+        if (result == GL_FALSE)
+        {
+            int length;
+            GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
+            std::vector<char> message(length + 1);
+            GLCall(glGetShaderInfoLog(id, length, &length, message.data()));
+            std::cerr << "BatchRenderer: failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+                      << " shader\n" << message.data() << std::endl;
+            GLCall(glDeleteShader(id));
+            return 0;
+        }
+        return id;
+    }
+
+    unsigned int CreateProgram()
+    {
+        std::string fragmentSource = FragmentShader();
+        unsigned int vs = CompileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+        unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentSource.c_str());
+        if (!vs || !fs)
+        {
+            if (vs)
+                GLCall(glDeleteShader(vs));
+            if (fs)
+                GLCall(glDeleteShader(fs));
+            return 0;
+        }
+
+        unsigned int program = glCreateProgram();
+        GLCall(glAttachShader(program, vs));
+        GLCall(glAttachShader(program, fs));
+        GLCall(glLinkProgram(program));
+        GLCall(glDeleteShader(vs));
+        GLCall(glDeleteShader(fs));
+
+        int linked;
+        GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+        if (linked == GL_FALSE)
+        {
+            std::cerr << "BatchRenderer: failed to link the batch shader" << std::endl;
+            GLCall(glDeleteProgram(program));
+            return 0;
+        }
+        return program;
+    }
+}
+
+IndexBuffer BatchRenderer::CreateQuadIndices(const VertexArray& va)
+{
+    // The element buffer binding is VAO state.
+    va.Bind();
+    std::vector<unsigned int> indices(MAX_QUADS * INDICES_PER_QUAD);
+    for (unsigned int quad = 0; quad < MAX_QUADS; quad++)
+    {
+        unsigned int* index = &indices[quad * INDICES_PER_QUAD];
+        unsigned int vertex = quad * VERTICES_PER_QUAD;
+        index[0] = vertex + 0;
+        index[1] = vertex + 1;
+        index[2] = vertex + 2;
+        index[3] = vertex + 2;
+        index[4] = vertex + 3;
+        index[5] = vertex + 0;
+    }
+    return IndexBuffer(indices.data(), (unsigned int)indices.size());
+}
+
+BatchRenderer::BatchRenderer()
+    : m_Vertices(REGION_SIZE, 4), m_Indices(CreateQuadIndices(m_VertexArray)), m_Program(CreateProgram()),
+      m_ViewProjectionLocation(-1), m_WhiteTexture(0), m_Slots{}, m_SlotCount(1), m_Write(nullptr), m_QuadCount(0),
+      m_ViewProjection{}
+{
+    m_VertexArray.AddBuffer<BatchVertex>(m_Vertices);
+
+    GLStateCache& state = GLStateCache::Get();
+    const unsigned char white[4] = {255, 255, 255, 255};
+    GLCall(glGenTextures(1, &m_WhiteTexture));
+    state.BindTexture(0, GL_TEXTURE_2D, m_WhiteTexture);
+    state.ActiveTexture(0);
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    m_Slots[0] = m_WhiteTexture;
+
+    if (!m_Program)
+        return;
+    state.UseProgram(m_Program);
+    m_ViewProjectionLocation = glGetUniformLocation(m_Program, "u_ViewProjection");
+    for (unsigned int slot = 0; slot < MAX_TEXTURE_SLOTS; slot++)
+    {
+        std::string name = "u_Textures[" + std::to_string(slot) + "]";
+        GLCall(glUniform1i(glGetUniformLocation(m_Program, name.c_str()), (int)slot));
+    }
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    if (m_Write)
+        m_Vertices.Unmap();
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::TEXTURE, m_WhiteTexture);
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::PROGRAM, m_Program);
+}
+
+uint32_t BatchRenderer::PackColor(float r, float g, float b, float a)
+{
+    auto channel = [](float value) { return (uint32_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    // Bytes in memory are r, g, b, a.
+    return channel(r) | channel(g) << 8 | channel(b) << 16 | channel(a) << 24;
+}
+
+void BatchRenderer::Begin(const float* viewProjection)
+{
+    static const float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    const float* source = viewProjection ? viewProjection : identity;
+    std::copy(source, source + 16, m_ViewProjection);
+    m_SlotCount = 1;
+    m_QuadCount = 0;
+}
+
+float BatchRenderer::FindSlot(unsigned int texture)
+{
+    if (texture == 0)
+        return 0.0f;
+    for (unsigned int slot = 1; slot < m_SlotCount; slot++)
+        if (m_Slots[slot] == texture)
+            return (float)slot;
+
+    if (m_SlotCount == MAX_TEXTURE_SLOTS)
+    {
+        m_Stats.textureSlotFlushes++;
+        Flush();
+    }
+    m_Slots[m_SlotCount] = texture;
+    return (float)m_SlotCount++;
+}
+
+void BatchRenderer::DrawQuad(float x, float y, float width, float height, uint32_t color, unsigned int texture,
+                             const float* uv)
+{
+    if (m_QuadCount == MAX_QUADS)
+    {
+        m_Stats.vertexBudgetFlushes++;
+        Flush();
+    }
+    float slot = FindSlot(texture);
+    if (!m_Write)
+        m_Write = static_cast<BatchVertex*>(m_Vertices.Map());
+
+    static const float fullUV[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    if (!uv)
+        uv = fullUV;
+    const float corners[VERTICES_PER_QUAD][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+    BatchVertex* vertex = m_Write + m_QuadCount * VERTICES_PER_QUAD;
+    for (unsigned int i = 0; i < VERTICES_PER_QUAD; i++)
+    {
+        // Write every field in order; the region may be write-combined memory.
+        vertex[i].position[0] = x + corners[i][0] * width;
+        vertex[i].position[1] = y + corners[i][1] * height;
+        std::memcpy(vertex[i].color, &color, sizeof(color));
+        vertex[i].uv[0] = corners[i][0] == 0.0f ? uv[0] : uv[2];
+        vertex[i].uv[1] = corners[i][1] == 0.0f ? uv[1] : uv[3];
+        vertex[i].slot = slot;
+    }
+    m_QuadCount++;
+    m_Stats.quads++;
+}
+
+void BatchRenderer::Flush()
+{
+    if (m_QuadCount == 0 || !m_Write)
+    {
+        m_SlotCount = 1;
+        return;
+    }
+    m_Vertices.Unmap();
+    m_Write = nullptr;
+
+    if (m_Program)
+    {
+        GLStateCache& state = GLStateCache::Get();
+        state.UseProgram(m_Program);
+        GLCall(glUniformMatrix4fv(m_ViewProjectionLocation, 1, GL_FALSE, m_ViewProjection));
+        for (unsigned int slot = 0; slot < m_SlotCount; slot++)
+            state.BindTexture(slot, GL_TEXTURE_2D, m_Slots[slot]);
+        m_VertexArray.Bind();
+
+        int baseVertex = (int)(m_Vertices.GetOffset() / sizeof(BatchVertex));
+        GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, m_QuadCount * INDICES_PER_QUAD, m_Indices.GetType(),
+                                        m_Indices.GetOffset(), baseVertex));
+        m_Stats.batches++;
+    }
+    m_Vertices.Fence();
+
+    m_QuadCount = 0;
+    m_SlotCount = 1;
+}
+
+void BatchRenderer::End()
+{
+    Flush();
+}
+
+void BatchRenderer::Report(std::ostream& out) const
+{
+    out << "BatchRenderer: " << m_Stats.quads << " quads in " << m_Stats.batches << " batches ("
+        << m_Stats.vertexBudgetFlushes << " cut by the vertex budget, " << m_Stats.textureSlotFlushes
+        << " by texture slots)" << std::endl;
+}
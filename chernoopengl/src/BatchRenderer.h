@@ -0,0 +1,93 @@
+#pragma once
+
+#include "IndexBuffer.h"
+#include "StreamVertexBuffer.h"
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+#include <cstdint>
+#include <ostream>
+
+struct BatchVertex
+{
+    float position[2];
+    unsigned char color[4];
+    float uv[2];
+    // Texture slot; a float because GL 3.3 has no integer attribute path here.
+    float slot;
+};
+VERTEX_LAYOUT(BatchVertex, VERTEX_ATTRIBUTE(BatchVertex, position), VERTEX_ATTRIBUTE(BatchVertex, color),
+              VERTEX_ATTRIBUTE(BatchVertex, uv), VERTEX_ATTRIBUTE(BatchVertex, slot))
+
+// Draws 2D quads in batches.
+//
+// Quads are written straight into a region of a StreamVertexBuffer and drawn
+// with one glDrawElementsBaseVertex against an index buffer holding the
+// 0,1,2,2,3,0 pattern for MAX_QUADS quads, built once. A batch is flushed
+// when it holds MAX_QUADS quads or a quad needs a texture while every slot is
+// taken; slot 0 is a white texture for untextured quads. Draw order is
+// submission order.
+//
+//     batch.Begin(viewProjection);
+//     batch.DrawQuad(x, y, w, h, BatchRenderer::PackColor(1, 0, 0, 1));
+//     batch.DrawQuad(x, y, w, h, white, texture);
+//     batch.End();
+class BatchRenderer
+{
+    public:
+        // 40000 vertices per batch keep the indices 16-bit.
+        static constexpr unsigned int MAX_QUADS = 10000;
+        // GL 3.3 guarantees 16 fragment texture units.
+        static constexpr unsigned int MAX_TEXTURE_SLOTS = 16;
+
+        struct Stats
+        {
+            unsigned long long quads = 0;
+            unsigned long long batches = 0;
+            // Why batches were cut short before End.
+            unsigned long long vertexBudgetFlushes = 0;
+            unsigned long long textureSlotFlushes = 0;
+        };
+
+    private:
+        VertexArray m_VertexArray;
+        StreamVertexBuffer m_Vertices;
+        IndexBuffer m_Indices;
+        unsigned int m_Program;
+        int m_ViewProjectionLocation;
+        unsigned int m_WhiteTexture;
+
+        unsigned int m_Slots[MAX_TEXTURE_SLOTS];
+        unsigned int m_SlotCount;
+        BatchVertex* m_Write;
+        unsigned int m_QuadCount;
+        float m_ViewProjection[16];
+        Stats m_Stats;
+
+        static IndexBuffer CreateQuadIndices(const VertexArray& va);
+        float FindSlot(unsigned int texture);
+        void Flush();
+
+    public:
+        BatchRenderer();
+        ~BatchRenderer();
+
+        BatchRenderer(const BatchRenderer&) = delete;
+        BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+        // False if the batch shader failed to build.
+        inline bool IsValid() const { return m_Program != 0; }
+
+        // viewProjection is column major; nullptr keeps positions in NDC.
+        void Begin(const float* viewProjection = nullptr);
+        // color is RGBA8 (see PackColor); uv is u0, v0, u1, v1 or nullptr for
+        // the whole texture; texture 0 means untextured.
+        void DrawQuad(float x, float y, float width, float height, uint32_t color, unsigned int texture = 0,
+                      const float* uv = nullptr);
+        void End();
+
+        static uint32_t PackColor(float r, float g, float b, float a);
+
+        inline const Stats& GetStats() const { return m_Stats; }
+        void ResetStats() { m_Stats = Stats(); }
+        void Report(std::ostream& out) const;
+};
@@ -0,0 +1,89 @@
+#include "BufferArena.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include "VertexArrayCache.h"
+#include <algorithm>
+
+BufferArena::BufferArena(unsigned int blockSize)
+    : m_BlockSize(blockSize), m_Allocations(0), m_PendingFrees(0), m_Self(std::make_shared<BufferArena*>(this))
+{
+}
+
+BufferArena::~BufferArena()
+{
+    // Anything not waiting on a deferred free belongs to a buffer that
+    // outlives the arena. Pending frees are dropped with the blocks, which
+    // the queue keeps alive until the GPU is done with them.
+    ASSERT(m_Allocations == m_PendingFrees);
+    m_Self.reset();
+    for (const Block& block : m_Blocks)
+    {
+        VertexArrayCache::Get().OnDeleteBuffer(block.buffer);
+        GLDeletionQueue::Get().Delete(GLDeletionQueue::BUFFER, block.buffer);
+    }
+}
+
+unsigned int BufferArena::CreateBlock(unsigned int size)
+{
+    unsigned int buffer;
+    GLCall(glGenBuffers(1, &buffer));
+    // Uploads go through GL_COPY_WRITE_BUFFER so they never disturb the
+    // element array binding of whatever VAO is bound.
+    GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW));
+    m_Blocks.push_back({buffer, OffsetAllocator(size)});
+    return (unsigned int)m_Blocks.size() - 1;
+}
+
+BufferAllocation BufferArena::Allocate(const void* data, unsigned int size, unsigned int alignment)
+{
+    alignment = std::max(alignment, 1u);
+    // Over-allocate so an aligned start always fits inside the range.
+    unsigned int padded = size + alignment - 1;
+
+    BufferAllocation allocation;
+    allocation.size = size;
+    for (unsigned int i = 0; i < m_Blocks.size() && allocation.range.offset == OffsetAllocator::INVALID; i++)
+    {
+        allocation.range = m_Blocks[i].allocator.Allocate(padded);
+        allocation.block = i;
+    }
+    if (allocation.range.offset == OffsetAllocator::INVALID)
+    {
+        allocation.block = CreateBlock(std::max(m_BlockSize, padded));
+        allocation.range = m_Blocks[allocation.block].allocator.Allocate(padded);
+    }
+
+    const Block& block = m_Blocks[allocation.block];
+    allocation.buffer = block.buffer;
+    allocation.offset = (allocation.range.offset + alignment - 1) / alignment * alignment;
+    if (data)
+    {
+        GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, block.buffer);
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset, size, data));
+    }
+    m_Allocations++;
+    return allocation;
+}
+
+void BufferArena::Free(const BufferAllocation& allocation)
+{
+    if (allocation.block >= m_Blocks.size() || allocation.range.node == OffsetAllocator::INVALID)
+        return;
+    m_Blocks[allocation.block].allocator.Free(allocation.range);
+    m_Allocations--;
+}
+
+void BufferArena::DeferFree(const BufferAllocation& allocation)
+{
+    m_PendingFrees++;
+    std::weak_ptr<BufferArena*> self = m_Self;
+    GLDeletionQueue::Get().Defer([self, allocation] {
+        if (std::shared_ptr<BufferArena*> arena = self.lock())
+        {
+            (*arena)->m_PendingFrees--;
+            (*arena)->Free(allocation);
+        }
+    });
+}
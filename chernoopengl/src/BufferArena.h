@@ -0,0 +1,60 @@
+#pragma once
+
+#include "OffsetAllocator.h"
+#include <memory>
+#include <vector>
+
+// A range handed out by a BufferArena. Draw with the arena buffer bound and
+// offset / stride as base vertex (vertex data) or offset as the index pointer.
+struct BufferAllocation
+{
+    unsigned int buffer = 0;
+    unsigned int offset = 0;
+    unsigned int size = 0;
+    unsigned int block = 0;
+    OffsetAllocator::Allocation range;
+};
+
+// Large GL buffers sub-allocated with an OffsetAllocator, so thousands of
+// small meshes share a handful of buffer bindings instead of one buffer
+// each. A new block is created when no existing block has room; requests
+// larger than the block size get a block of their own. Destroy every
+// buffer allocated from an arena before the arena itself.
+class BufferArena
+{
+    private:
+        struct Block
+        {
+            unsigned int buffer;
+            OffsetAllocator allocator;
+        };
+
+        std::vector<Block> m_Blocks;
+        unsigned int m_BlockSize;
+        unsigned int m_Allocations;
+        // Allocations released through DeferFree whose frame is in flight.
+        unsigned int m_PendingFrees;
+        // Deferred frees hold a weak reference; the arena resets it on
+        // destruction so late callbacks find nothing to free.
+        std::shared_ptr<BufferArena*> m_Self;
+
+        unsigned int CreateBlock(unsigned int size);
+
+    public:
+        explicit BufferArena(unsigned int blockSize = 16 * 1024 * 1024);
+        ~BufferArena();
+
+        BufferArena(const BufferArena&) = delete;
+        BufferArena& operator=(const BufferArena&) = delete;
+
+        // Uploads size bytes at an offset that is a multiple of alignment
+        // (use the vertex stride so offset / stride is an exact base vertex).
+        BufferAllocation Allocate(const void* data, unsigned int size, unsigned int alignment = 4);
+        void Free(const BufferAllocation& allocation);
+        // Frees the range once the current frame has completed on the GPU,
+        // through the GLDeletionQueue. Safe if the arena is destroyed first.
+        void DeferFree(const BufferAllocation& allocation);
+
+        inline unsigned int GetBlockCount() const { return (unsigned int)m_Blocks.size(); }
+        inline unsigned int GetAllocationCount() const { return m_Allocations; }
+};
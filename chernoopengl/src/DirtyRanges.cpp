@@ -0,0 +1,61 @@
+#include "DirtyRanges.h"
+#include <algorithm>
+
+DirtyRanges::DirtyRanges()
+    : m_Sorted(true)
+{
+}
+
+void DirtyRanges::Add(unsigned int offset, unsigned int size)
+{
+    if (size == 0)
+        return;
+    // Extending the last range covers the common sequential-write pattern
+    // without growing the list.
+    if (!m_Ranges.empty())
+    {
+        Range& last = m_Ranges.back();
+        if (offset >= last.begin && offset <= last.end)
+        {
+            last.end = std::max(last.end, offset + size);
+            return;
+        }
+    }
+    m_Ranges.push_back({offset, offset + size});
+    m_Sorted = m_Ranges.size() == 1;
+}
+
+void DirtyRanges::Coalesce(unsigned int mergeGap)
+{
+    if (m_Ranges.size() < 2)
+        return;
+    if (!m_Sorted)
+        std::sort(m_Ranges.begin(), m_Ranges.end(), [](const Range& a, const Range& b) { return a.begin < b.begin; });
+
+    size_t out = 0;
+    for (size_t i = 1; i < m_Ranges.size(); i++)
+    {
+        Range& current = m_Ranges[out];
+        const Range& next = m_Ranges[i];
+        if (next.begin <= current.end + mergeGap)
+            current.end = std::max(current.end, next.end);
+        else
+            m_Ranges[++out] = next;
+    }
+    m_Ranges.resize(out + 1);
+    m_Sorted = true;
+}
+
+void DirtyRanges::Clear()
+{
+    m_Ranges.clear();
+    m_Sorted = true;
+}
+
+unsigned int DirtyRanges::GetDirtyBytes() const
+{
+    unsigned int bytes = 0;
+    for (const Range& range : m_Ranges)
+        bytes += range.end - range.begin;
+    return bytes;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+// Byte ranges written since the last flush. Add is O(1); Coalesce sorts the
+// ranges and merges those that overlap or lie within mergeGap bytes of each
+// other, since one slightly larger upload beats two driver calls.
+class DirtyRanges
+{
+    public:
+        struct Range
+        {
+            unsigned int begin;
+            unsigned int end;
+        };
+
+    private:
+        std::vector<Range> m_Ranges;
+        bool m_Sorted;
+
+    public:
+        DirtyRanges();
+
+        void Add(unsigned int offset, unsigned int size);
+        void Coalesce(unsigned int mergeGap = 0);
+        void Clear();
+
+        inline bool IsEmpty() const { return m_Ranges.empty(); }
+        // Coalesce first, or overlapping ranges are counted twice.
+        unsigned int GetDirtyBytes() const;
+        inline const std::vector<Range>& GetRanges() const { return m_Ranges; }
+};
@@ -1,24 +1,149 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include "VertexArrayCache.h"
+#include "IndexNarrowing.h"
+#include <vector>
+
+namespace
+{
+    // Narrowed copy of the indices; empty when they stay 32-bit.
+    struct NarrowedIndices
+    {
+        unsigned int type;
+        std::vector<unsigned char> bytes;
+    };
+
+    NarrowedIndices NarrowIndexData(const unsigned int* data, unsigned int count)
+    {
+        NarrowedIndices result = {GL_UNSIGNED_INT, {}};
+        unsigned int max = MaxIndex(data, count);
+        if (max <= 0xFF)
+        {
+            result.type = GL_UNSIGNED_BYTE;
+            result.bytes.resize(count);
+            NarrowIndices(data, count, (uint8_t*)result.bytes.data());
+        }
+        else if (max <= 0xFFFF)
+        {
+            result.type = GL_UNSIGNED_SHORT;
+            result.bytes.resize(count * sizeof(uint16_t));
+            NarrowIndices(data, count, (uint16_t*)result.bytes.data());
+        }
+        return result;
+    }
+
+    unsigned int SizeOfIndexType(unsigned int type)
+    {
+        switch (type)
+        {
+            case GL_UNSIGNED_BYTE: return 1;
+            case GL_UNSIGNED_SHORT: return 2;
+        }
+        return 4;
+    }
+}
+
+IndexBuffer::IndexBuffer()
+    :m_RendererID(0), m_Count(0), m_Type(GL_UNSIGNED_INT), m_Arena(nullptr)
+{
+}
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-    :m_Count(count)
+    :m_Count(count), m_Arena(nullptr)
 {
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
+    NarrowedIndices narrowed = NarrowIndexData(data, count);
+    m_Type = narrowed.type;
+    const void* upload = narrowed.bytes.empty() ? (const void*)data : narrowed.bytes.data();
+
     GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * GetIndexSize(), upload, GL_STATIC_DRAW));
     
 }
+IndexBuffer::IndexBuffer(BufferArena& arena, const unsigned int* data, unsigned int count)
+    :m_Count(count), m_Arena(&arena)
+{
+    NarrowedIndices narrowed = NarrowIndexData(data, count);
+    m_Type = narrowed.type;
+    const void* upload = narrowed.bytes.empty() ? (const void*)data : narrowed.bytes.data();
+
+    m_Allocation = arena.Allocate(upload, count * GetIndexSize(), GetIndexSize());
+    m_RendererID = m_Allocation.buffer;
+}
 IndexBuffer::~IndexBuffer()
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
+    Release();
+}
+
+IndexBuffer IndexBuffer::Adopt(unsigned int rendererID, unsigned int count, unsigned int type)
+{
+    IndexBuffer ib;
+    ib.m_RendererID = rendererID;
+    ib.m_Count = count;
+    ib.m_Type = type;
+    return ib;
+}
+
+std::vector<unsigned char> IndexBuffer::Narrow(const unsigned int* data, unsigned int count, unsigned int& type)
+{
+    NarrowedIndices narrowed = NarrowIndexData(data, count);
+    type = narrowed.type;
+    if (narrowed.bytes.empty())
+        narrowed.bytes.assign((const unsigned char*)data, (const unsigned char*)(data + count));
+    return std::move(narrowed.bytes);
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+    :m_RendererID(other.m_RendererID), m_Count(other.m_Count), m_Type(other.m_Type),
+     m_Arena(other.m_Arena), m_Allocation(other.m_Allocation)
+{
+    other.m_RendererID = 0;
+    other.m_Count = 0;
+    other.m_Arena = nullptr;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_RendererID = other.m_RendererID;
+        m_Count = other.m_Count;
+        m_Type = other.m_Type;
+        m_Arena = other.m_Arena;
+        m_Allocation = other.m_Allocation;
+        other.m_RendererID = 0;
+        other.m_Count = 0;
+        other.m_Arena = nullptr;
+    }
+    return *this;
+}
+
+void IndexBuffer::Release()
+{
+    if (m_Arena)
+        m_Arena->DeferFree(m_Allocation);
+    else if (m_RendererID)
+    {
+        VertexArrayCache::Get().OnDeleteBuffer(m_RendererID);
+        GLDeletionQueue::Get().Delete(GLDeletionQueue::BUFFER, m_RendererID);
+    }
+    m_RendererID = 0;
+    m_Arena = nullptr;
+}
+
+unsigned int IndexBuffer::GetIndexSize() const
+{
+    return SizeOfIndexType(m_Type);
 }
 
 void IndexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 void IndexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
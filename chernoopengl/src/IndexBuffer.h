@@ -1,17 +1,47 @@
 #pragma once
 
+#include "BufferArena.h"
+#include <cstddef>
+#include <vector>
+
+// Stores indices in the narrowest type that holds the largest index
+// (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT); draw with
+// GetType() instead of a hardcoded GL_UNSIGNED_INT. Move only, like
+// VertexBuffer.
 class IndexBuffer
 {
     private:
     unsigned int m_RendererID;
     unsigned int m_Count;
+    unsigned int m_Type;
+    BufferArena* m_Arena;
+    BufferAllocation m_Allocation;
+
+    IndexBuffer();
+    void Release();
 
     public:
     IndexBuffer(const unsigned int* data, unsigned int count);
+    IndexBuffer(BufferArena& arena, const unsigned int* data, unsigned int count);
     ~IndexBuffer();
+    // Takes ownership of a buffer filled elsewhere, e.g. by AsyncUploader
+    // with the bytes from Narrow.
+    static IndexBuffer Adopt(unsigned int rendererID, unsigned int count, unsigned int type);
+    // The indices as they would be stored, and their type.
+    static std::vector<unsigned char> Narrow(const unsigned int* data, unsigned int count, unsigned int& type);
+
+    IndexBuffer(const IndexBuffer&) = delete;
+    IndexBuffer& operator=(const IndexBuffer&) = delete;
+    IndexBuffer(IndexBuffer&& other) noexcept;
+    IndexBuffer& operator=(IndexBuffer&& other) noexcept;
 
     void Bind() const;
     void Unbind() const;
 
+    inline unsigned int GetRendererID() const { return m_RendererID; }
     inline unsigned int GetCount() const { return m_Count;}
-};
\ No newline at end of file
+    inline unsigned int GetType() const { return m_Type; }
+    unsigned int GetIndexSize() const;
+    // Pass as the indices argument of glDrawElements*.
+    inline const void* GetOffset() const { return (const void*)(size_t)m_Allocation.offset; }
+};
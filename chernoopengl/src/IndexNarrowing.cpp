@@ -0,0 +1,106 @@
+#include "IndexNarrowing.h"
+#include <algorithm>
+
+#if defined(__SSE4_1__)
+    #include <smmintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define INDEX_SSE2 1
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+unsigned int MaxIndex(const unsigned int* data, unsigned int count)
+{
+    unsigned int i = 0;
+    unsigned int result = 0;
+
+#if defined(__SSE4_1__)
+    __m128i max = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+        max = _mm_max_epu32(max, _mm_loadu_si128((const __m128i*)(data + i)));
+    max = _mm_max_epu32(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(1, 0, 3, 2)));
+    max = _mm_max_epu32(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(2, 3, 0, 1)));
+    result = (unsigned int)_mm_cvtsi128_si32(max);
+#elif defined(INDEX_SSE2)
+    // No unsigned 32-bit max before SSE4.1: flip the sign bit and use the
+    // signed compare.
+    const __m128i bias = _mm_set1_epi32((int)0x80000000);
+    __m128i max = bias;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i value = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(data + i)), bias);
+        __m128i greater = _mm_cmpgt_epi32(value, max);
+        max = _mm_or_si128(_mm_and_si128(greater, value), _mm_andnot_si128(greater, max));
+    }
+    alignas(16) unsigned int lanes[4];
+    _mm_store_si128((__m128i*)lanes, _mm_xor_si128(max, bias));
+    result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint32x4_t max = vdupq_n_u32(0);
+    for (; i + 4 <= count; i += 4)
+        max = vmaxq_u32(max, vld1q_u32(data + i));
+    result = vmaxvq_u32(max);
+#endif
+
+    for (; i < count; i++)
+        result = std::max(result, data[i]);
+    return result;
+}
+
+void NarrowIndices(const unsigned int* data, unsigned int count, uint16_t* out)
+{
+    unsigned int i = 0;
+
+#if defined(__SSE4_1__)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i high = _mm_loadu_si128((const __m128i*)(data + i + 4));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi32(low, high));
+    }
+#elif defined(INDEX_SSE2)
+    // Only a signed pack exists: shift into signed range, pack, shift back.
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(data + i)), bias32);
+        __m128i high = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(data + i + 4)), bias32);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(_mm_packs_epi32(low, high), bias16));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x4_t low = vmovn_u32(vld1q_u32(data + i));
+        uint16x4_t high = vmovn_u32(vld1q_u32(data + i + 4));
+        vst1q_u16(out + i, vcombine_u16(low, high));
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = (uint16_t)data[i];
+}
+
+void NarrowIndices(const unsigned int* data, unsigned int count, uint8_t* out)
+{
+    unsigned int i = 0;
+
+#if defined(__SSE4_1__) || defined(INDEX_SSE2)
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a = _mm_packs_epi32(_mm_loadu_si128((const __m128i*)(data + i)), _mm_loadu_si128((const __m128i*)(data + i + 4)));
+        __m128i b = _mm_packs_epi32(_mm_loadu_si128((const __m128i*)(data + i + 8)), _mm_loadu_si128((const __m128i*)(data + i + 12)));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(a, b));
+    }
+#elif defined(__ARM_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t words = vcombine_u16(vmovn_u32(vld1q_u32(data + i)), vmovn_u32(vld1q_u32(data + i + 4)));
+        vst1_u8(out + i, vmovn_u16(words));
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = (uint8_t)data[i];
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// SIMD helpers used by IndexBuffer to store indices in the narrowest type.
+// SSE4.1/SSE2 on x86, NEON on ARM, scalar elsewhere.
+
+unsigned int MaxIndex(const unsigned int* data, unsigned int count);
+
+// Callers guarantee every index fits the destination type (see MaxIndex).
+void NarrowIndices(const unsigned int* data, unsigned int count, uint16_t* out);
+void NarrowIndices(const unsigned int* data, unsigned int count, uint8_t* out);
@@ -0,0 +1,152 @@
+#include "IndirectDrawList.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Commands per WorkerPool chunk; filling one is a handful of loads.
+    constexpr size_t BUILD_GRAIN = 4096;
+
+    bool HasMultiDrawIndirect()
+    {
+        bool supported = false;
+#if defined(GL_VERSION_4_3)
+        supported = supported || GLAD_GL_VERSION_4_3;
+#endif
+#if defined(GL_ARB_multi_draw_indirect)
+        supported = supported || GLAD_GL_ARB_multi_draw_indirect;
+#endif
+        return supported;
+    }
+}
+
+IndirectDrawList::IndirectDrawList(unsigned int stride, bool allowMultiDraw)
+    : m_Stride(stride), m_MultiDraw(allowMultiDraw && HasMultiDrawIndirect()), m_CommandBuffer(0),
+      m_CommandBufferSize(0)
+{
+    if (m_MultiDraw)
+        GLCall(glGenBuffers(1, &m_CommandBuffer));
+}
+
+IndirectDrawList::~IndirectDrawList()
+{
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::BUFFER, m_CommandBuffer);
+}
+
+void IndirectDrawList::Clear()
+{
+    m_Draws.clear();
+    m_Groups.clear();
+    m_GroupLookup.clear();
+}
+
+void IndirectDrawList::Add(const VertexBuffer& vb, const IndexBuffer& ib, unsigned int instanceCount, unsigned int baseInstance)
+{
+    uint64_t key = ((uint64_t)vb.GetRendererID() << 32 | ib.GetRendererID()) ^ ((uint64_t)ib.GetType() << 16);
+    auto inserted = m_GroupLookup.emplace(key, (unsigned int)m_Groups.size());
+    if (inserted.second)
+        m_Groups.push_back({&vb, &ib, ib.GetType(), 0, 0});
+    Group& group = m_Groups[inserted.first->second];
+    m_Draws.push_back({&vb, &ib, instanceCount, baseInstance, inserted.first->second, group.count++});
+}
+
+void IndirectDrawList::Build()
+{
+    auto start = Clock::now();
+
+    unsigned int first = 0;
+    for (Group& group : m_Groups)
+    {
+        group.first = first;
+        first += group.count;
+    }
+    m_Commands.resize(m_Draws.size());
+
+    // Every draw knows its slot, so workers write disjoint commands.
+    WorkerPool::Get().ParallelFor(m_Draws.size(), BUILD_GRAIN, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            const Draw& draw = m_Draws[i];
+            const IndexBuffer& ib = *draw.ib;
+            DrawElementsIndirectCommand& command = m_Commands[m_Groups[draw.group].first + draw.rank];
+            command.count = ib.GetCount();
+            command.instanceCount = draw.instanceCount;
+            command.firstIndex = (uint32_t)((size_t)ib.GetOffset() / ib.GetIndexSize());
+            command.baseVertex = (int32_t)draw.vb->GetBaseVertex(m_Stride);
+            command.baseInstance = draw.baseInstance;
+        }
+    });
+
+    if (m_MultiDraw)
+        Upload();
+
+    m_Stats.draws = (unsigned int)m_Draws.size();
+    m_Stats.groups = (unsigned int)m_Groups.size();
+    m_Stats.drawCalls = 0;
+    m_Stats.buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void IndirectDrawList::Upload()
+{
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+    unsigned int size = (unsigned int)(m_Commands.size() * sizeof(DrawElementsIndirectCommand));
+    GLStateCache::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+    // Orphan: last frame's commands may still be read by the GPU.
+    GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, std::max(size, m_CommandBufferSize), nullptr, GL_STREAM_DRAW));
+    m_CommandBufferSize = std::max(size, m_CommandBufferSize);
+    if (size)
+        GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, m_Commands.data()));
+#endif
+}
+
+void IndirectDrawList::Execute(const Group& group)
+{
+    if (group.count == 0)
+        return;
+
+    if (m_MultiDraw)
+    {
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+        GLStateCache::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+        const void* offset = (const void*)(size_t)(group.first * sizeof(DrawElementsIndirectCommand));
+        GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, group.indexType, offset, (GLsizei)group.count, 0));
+        m_Stats.drawCalls++;
+#endif
+        return;
+    }
+
+    unsigned int indexSize = group.ib->GetIndexSize();
+    for (unsigned int i = group.first; i < group.first + group.count; i++)
+    {
+        const DrawElementsIndirectCommand& command = m_Commands[i];
+        const void* indices = (const void*)(size_t)(command.firstIndex * indexSize);
+        GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)command.count, group.indexType, indices,
+                                                 (GLsizei)command.instanceCount, command.baseVertex));
+    }
+    m_Stats.drawCalls += group.count;
+}
+
+void IndirectDrawList::Submit(const VertexArray& va)
+{
+    ASSERT(m_Groups.size() <= 1);
+    va.Bind();
+    for (const Group& group : m_Groups)
+    {
+        GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, group.ib->GetRendererID());
+        Execute(group);
+    }
+}
+
+void IndirectDrawList::Report(std::ostream& out) const
+{
+    out << "IndirectDrawList: " << m_Stats.draws << " draws in " << m_Stats.groups << " groups, "
+        << m_Stats.drawCalls << " draw calls ("
+        << (m_MultiDraw ? "glMultiDrawElementsIndirect" : "glDrawElementsInstancedBaseVertex loop") << "), build "
+        << m_Stats.buildMs << " ms" << std::endl;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "VertexArrayCache.h"
+#include "VertexBuffer.h"
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+// Layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand
+{
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// Many meshes drawn with one call per buffer pair.
+//
+// Meshes are arena backed (BufferArena), so thousands of them share a few
+// vertex and index buffers. Add sorts each draw into a group by its vertex
+// buffer, index buffer and index type; Build fills the command array on the
+// WorkerPool and uploads it; Submit binds each group once and issues one
+// glMultiDrawElementsIndirect for it (GL 4.3 / ARB_multi_draw_indirect).
+// Without it Submit loops glDrawElementsInstancedBaseVertex over the same
+// commands, still saving every per-mesh bind; baseInstance is then ignored.
+//
+//     list.Clear();
+//     for (Mesh& mesh : meshes) list.Add(mesh.vb, mesh.ib);
+//     list.Build();
+//     list.Submit<Vertex>();
+class IndirectDrawList
+{
+    public:
+        struct Stats
+        {
+            unsigned int draws = 0;
+            unsigned int groups = 0;
+            unsigned int drawCalls = 0;
+            // Command array fill and upload.
+            double buildMs = 0.0;
+        };
+
+    private:
+        struct Draw
+        {
+            const VertexBuffer* vb;
+            const IndexBuffer* ib;
+            unsigned int instanceCount;
+            unsigned int baseInstance;
+            unsigned int group;
+            unsigned int rank;
+        };
+
+        struct Group
+        {
+            const VertexBuffer* vb;
+            const IndexBuffer* ib;
+            unsigned int indexType;
+            unsigned int count;
+            unsigned int first;
+        };
+
+        unsigned int m_Stride;
+        bool m_MultiDraw;
+        unsigned int m_CommandBuffer;
+        unsigned int m_CommandBufferSize;
+        std::vector<Draw> m_Draws;
+        std::vector<Group> m_Groups;
+        // (vertex buffer << 32 | index buffer) ^ type -> index into m_Groups
+        std::unordered_map<uint64_t, unsigned int> m_GroupLookup;
+        std::vector<DrawElementsIndirectCommand> m_Commands;
+        Stats m_Stats;
+
+        void Upload();
+        void Execute(const Group& group);
+
+    public:
+        // stride is the vertex size, to turn arena offsets into base vertices.
+        // allowMultiDraw = false forces the 3.3 path.
+        explicit IndirectDrawList(unsigned int stride, bool allowMultiDraw = true);
+        ~IndirectDrawList();
+
+        IndirectDrawList(const IndirectDrawList&) = delete;
+        IndirectDrawList& operator=(const IndirectDrawList&) = delete;
+
+        void Clear();
+        // vb and ib must outlive Submit.
+        void Add(const VertexBuffer& vb, const IndexBuffer& ib, unsigned int instanceCount = 1, unsigned int baseInstance = 0);
+        void Build();
+
+        // Binds every group through the VertexArrayCache.
+        template<typename Vertex>
+        void Submit()
+        {
+            for (const Group& group : m_Groups)
+            {
+                VertexArrayCache::Get().Bind<Vertex>(*group.vb, group.ib);
+                Execute(group);
+            }
+        }
+        // For a single group: va has the group's vertex buffer attached.
+        void Submit(const VertexArray& va);
+
+        inline bool UsesMultiDraw() const { return m_MultiDraw; }
+        inline unsigned int GetGroupCount() const { return (unsigned int)m_Groups.size(); }
+        inline const Stats& GetStats() const { return m_Stats; }
+        void Report(std::ostream& out) const;
+};
@@ -0,0 +1,195 @@
+#include "OffsetAllocator.h"
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace
+{
+    uint32_t FloorLog2(uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse(&index, value);
+        return index;
+#else
+        return 31 - __builtin_clz(value);
+#endif
+    }
+
+    uint32_t CountTrailingZeros(uint64_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+}
+
+OffsetAllocator::OffsetAllocator(uint32_t size)
+    : m_Size(size), m_FreeBytes(0)
+{
+    for (uint32_t& head : m_BinHeads)
+        head = INVALID;
+    for (uint64_t& word : m_BinBitmap)
+        word = 0;
+
+    if (size)
+    {
+        uint32_t node = NewNode(0, size);
+        InsertFree(node);
+    }
+}
+
+// Sizes below SL_COUNT map 1:1; above, each power of two is split into
+// SL_COUNT bins by the bits right below the leading one.
+uint32_t OffsetAllocator::BinFloor(uint32_t size)
+{
+    if (size < SL_COUNT)
+        return size;
+    uint32_t log2 = FloorLog2(size);
+    uint32_t sl = (size >> (log2 - SL_BITS)) & (SL_COUNT - 1);
+    uint32_t fl = log2 - SL_BITS + 1;
+    return fl * SL_COUNT + sl;
+}
+
+uint32_t OffsetAllocator::BinLowerBound(uint32_t bin)
+{
+    if (bin < SL_COUNT)
+        return bin;
+    uint32_t fl = bin / SL_COUNT;
+    uint32_t sl = bin % SL_COUNT;
+    uint32_t log2 = fl + SL_BITS - 1;
+    return (SL_COUNT + sl) << (log2 - SL_BITS);
+}
+
+uint32_t OffsetAllocator::NewNode(uint32_t offset, uint32_t size)
+{
+    Node node = {offset, size, INVALID, INVALID, INVALID, INVALID, false};
+    if (!m_FreeNodes.empty())
+    {
+        uint32_t index = m_FreeNodes.back();
+        m_FreeNodes.pop_back();
+        m_Nodes[index] = node;
+        return index;
+    }
+    m_Nodes.push_back(node);
+    return (uint32_t)m_Nodes.size() - 1;
+}
+
+void OffsetAllocator::InsertFree(uint32_t index)
+{
+    Node& node = m_Nodes[index];
+    uint32_t bin = BinFloor(node.size);
+    node.used = false;
+    node.prevFree = INVALID;
+    node.nextFree = m_BinHeads[bin];
+    if (node.nextFree != INVALID)
+        m_Nodes[node.nextFree].prevFree = index;
+    m_BinHeads[bin] = index;
+    m_BinBitmap[bin / 64] |= 1ull << (bin % 64);
+    m_FreeBytes += node.size;
+}
+
+void OffsetAllocator::RemoveFree(uint32_t index)
+{
+    Node& node = m_Nodes[index];
+    uint32_t bin = BinFloor(node.size);
+    if (node.prevFree != INVALID)
+        m_Nodes[node.prevFree].nextFree = node.nextFree;
+    else
+        m_BinHeads[bin] = node.nextFree;
+    if (node.nextFree != INVALID)
+        m_Nodes[node.nextFree].prevFree = node.prevFree;
+    if (m_BinHeads[bin] == INVALID)
+        m_BinBitmap[bin / 64] &= ~(1ull << (bin % 64));
+    m_FreeBytes -= node.size;
+}
+
+uint32_t OffsetAllocator::FindBin(uint32_t first) const
+{
+    for (uint32_t word = first / 64; word < sizeof(m_BinBitmap) / sizeof(m_BinBitmap[0]); word++)
+    {
+        uint64_t bits = m_BinBitmap[word];
+        if (word == first / 64)
+            bits &= ~0ull << (first % 64);
+        if (bits)
+            return word * 64 + CountTrailingZeros(bits);
+    }
+    return INVALID;
+}
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32_t size)
+{
+    Allocation allocation;
+    if (size == 0 || size > m_FreeBytes)
+        return allocation;
+
+    // Round up to the next bin so any node found there is large enough.
+    uint32_t bin = BinFloor(size);
+    if (BinLowerBound(bin) < size)
+        bin++;
+    if (bin >= BIN_COUNT)
+        return allocation;
+    bin = FindBin(bin);
+    if (bin == INVALID)
+        return allocation;
+
+    uint32_t index = m_BinHeads[bin];
+    RemoveFree(index);
+
+    if (m_Nodes[index].size > size)
+    {
+        uint32_t rest = NewNode(m_Nodes[index].offset + size, m_Nodes[index].size - size);
+        Node& node = m_Nodes[index];
+        node.size = size;
+        m_Nodes[rest].prevPhysical = index;
+        m_Nodes[rest].nextPhysical = node.nextPhysical;
+        if (node.nextPhysical != INVALID)
+            m_Nodes[node.nextPhysical].prevPhysical = rest;
+        node.nextPhysical = rest;
+        InsertFree(rest);
+    }
+
+    m_Nodes[index].used = true;
+    allocation.offset = m_Nodes[index].offset;
+    allocation.node = index;
+    return allocation;
+}
+
+void OffsetAllocator::Free(const Allocation& allocation)
+{
+    if (allocation.node == INVALID)
+        return;
+
+    uint32_t index = allocation.node;
+
+    // Merge into a free left neighbour, then swallow a free right neighbour.
+    uint32_t prev = m_Nodes[index].prevPhysical;
+    if (prev != INVALID && !m_Nodes[prev].used)
+    {
+        RemoveFree(prev);
+        m_Nodes[prev].size += m_Nodes[index].size;
+        m_Nodes[prev].nextPhysical = m_Nodes[index].nextPhysical;
+        if (m_Nodes[index].nextPhysical != INVALID)
+            m_Nodes[m_Nodes[index].nextPhysical].prevPhysical = prev;
+        m_FreeNodes.push_back(index);
+        index = prev;
+    }
+
+    uint32_t next = m_Nodes[index].nextPhysical;
+    if (next != INVALID && !m_Nodes[next].used)
+    {
+        RemoveFree(next);
+        m_Nodes[index].size += m_Nodes[next].size;
+        m_Nodes[index].nextPhysical = m_Nodes[next].nextPhysical;
+        if (m_Nodes[next].nextPhysical != INVALID)
+            m_Nodes[m_Nodes[next].nextPhysical].prevPhysical = index;
+        m_FreeNodes.push_back(next);
+    }
+
+    InsertFree(index);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// TLSF (two-level segregated fit) allocator over an abstract [0, size) range.
+// It never touches the memory it manages, so it can hand out ranges of a GL
+// buffer. Allocation and free are O(1): free ranges live in 16 bins per power
+// of two, found through a bitmap, and neighbours are coalesced on free.
+class OffsetAllocator
+{
+    public:
+        static constexpr uint32_t INVALID = ~0u;
+
+        struct Allocation
+        {
+            uint32_t offset = INVALID;
+            uint32_t node = INVALID;
+        };
+
+    private:
+        static constexpr uint32_t SL_BITS = 4;
+        static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+        static constexpr uint32_t BIN_COUNT = 29 * SL_COUNT;
+
+        struct Node
+        {
+            uint32_t offset;
+            uint32_t size;
+            uint32_t prevPhysical;
+            uint32_t nextPhysical;
+            uint32_t prevFree;
+            uint32_t nextFree;
+            bool used;
+        };
+
+        std::vector<Node> m_Nodes;
+        std::vector<uint32_t> m_FreeNodes;
+        uint32_t m_BinHeads[BIN_COUNT];
+        uint64_t m_BinBitmap[(BIN_COUNT + 63) / 64];
+        uint32_t m_Size;
+        uint32_t m_FreeBytes;
+
+        static uint32_t BinFloor(uint32_t size);
+        static uint32_t BinLowerBound(uint32_t bin);
+
+        uint32_t NewNode(uint32_t offset, uint32_t size);
+        void InsertFree(uint32_t node);
+        void RemoveFree(uint32_t node);
+        uint32_t FindBin(uint32_t first) const;
+
+    public:
+        explicit OffsetAllocator(uint32_t size);
+
+        // Returns an allocation with offset INVALID when nothing fits.
+        Allocation Allocate(uint32_t size);
+        void Free(const Allocation& allocation);
+
+        inline uint32_t GetSize() const { return m_Size; }
+        inline uint32_t GetFreeBytes() const { return m_FreeBytes; }
+};
@@ -1,16 +1,295 @@
 #include "Renderer.h"
-#include <iostream>
+#include "GLStateCache.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
 
-void GLClearError()
+namespace
 {
-    while (glGetError() != GL_NO_ERROR);
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint64_t FIELD_MASK = 0xfff;
+    constexpr uint64_t DEPTH_MASK = 0xffffff;
+
+    uint64_t QuantizeDepth(float depth)
+    {
+        depth = std::min(std::max(depth, 0.0f), 1.0f);
+        return (uint64_t)(depth * (float)DEPTH_MASK) & DEPTH_MASK;
+    }
+
+    // LSD radix sort on 8-bit digits. Digits every key shares are skipped,
+    // which is most of them when a frame only uses a few programs and VAOs.
+    template<typename Item>
+    void RadixSort(std::vector<Item>& items, std::vector<Item>& scratch)
+    {
+        scratch.resize(items.size());
+        Item* from = items.data();
+        Item* to = scratch.data();
+        size_t count = items.size();
+        for (unsigned int shift = 0; shift < 64; shift += 8)
+        {
+            size_t offsets[256] = {};
+            for (size_t i = 0; i < count; i++)
+                offsets[(from[i].key >> shift) & 0xff]++;
+            if (offsets[(from[0].key >> shift) & 0xff] == count)
+                continue;
+
+            size_t sum = 0;
+            for (size_t& offset : offsets)
+            {
+                size_t bucket = offset;
+                offset = sum;
+                sum += bucket;
+            }
+            for (size_t i = 0; i < count; i++)
+                to[offsets[(from[i].key >> shift) & 0xff]++] = from[i];
+            std::swap(from, to);
+        }
+        if (from != items.data())
+            std::memcpy(items.data(), from, count * sizeof(Item));
+    }
+}
+
+Renderer::Uniform Renderer::Uniform::Int(int location, int value)
+{
+    Uniform uniform;
+    uniform.location = location;
+    uniform.type = INT;
+    uniform.i = value;
+    return uniform;
+}
+
+Renderer::Uniform Renderer::Uniform::Float(int location, float value)
+{
+    Uniform uniform;
+    uniform.location = location;
+    uniform.type = FLOAT;
+    uniform.f[0] = value;
+    return uniform;
+}
+
+Renderer::Uniform Renderer::Uniform::Vec2(int location, float x, float y)
+{
+    Uniform uniform;
+    uniform.location = location;
+    uniform.type = VEC2;
+    uniform.f[0] = x;
+    uniform.f[1] = y;
+    return uniform;
+}
+
+Renderer::Uniform Renderer::Uniform::Vec3(int location, float x, float y, float z)
+{
+    Uniform uniform;
+    uniform.location = location;
+    uniform.type = VEC3;
+    uniform.f[0] = x;
+    uniform.f[1] = y;
+    uniform.f[2] = z;
+    return uniform;
+}
+
+Renderer::Uniform Renderer::Uniform::Vec4(int location, float x, float y, float z, float w)
+{
+    Uniform uniform;
+    uniform.location = location;
+    uniform.type = VEC4;
+    uniform.f[0] = x;
+    uniform.f[1] = y;
+    uniform.f[2] = z;
+    uniform.f[3] = w;
+    return uniform;
+}
+
+Renderer::Uniform Renderer::Uniform::Mat4(int location, const float* values)
+{
+    Uniform uniform;
+    uniform.location = location;
+    uniform.type = MAT4;
+    std::memcpy(uniform.f, values, sizeof(uniform.f));
+    return uniform;
+}
+
+unsigned int Renderer::InternTextureSet(const Draw& draw)
+{
+    ASSERT(draw.textureCount <= MAX_TEXTURE_UNITS);
+    // FNV-1a over the names
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned int i = 0; i < draw.textureCount; i++)
+        hash = (hash ^ draw.textures[i]) * 1099511628211ull;
+    hash ^= draw.textureCount;
+
+    auto range = m_TextureSetLookup.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const TextureSet& set = m_TextureSets[it->second];
+        if (set.count == draw.textureCount &&
+            std::equal(draw.textures, draw.textures + draw.textureCount, set.textures))
+            return it->second;
+    }
+
+    TextureSet set = {};
+    std::copy(draw.textures, draw.textures + draw.textureCount, set.textures);
+    set.count = draw.textureCount;
+    unsigned int index = (unsigned int)m_TextureSets.size();
+    m_TextureSets.push_back(set);
+    m_TextureSetLookup.emplace(hash, index);
+    return index;
+}
+
+uint64_t Renderer::MakeKey(const Draw& draw, unsigned int textureSet)
+{
+    uint64_t pass = (uint64_t)draw.pass;
+    uint64_t program = draw.program & FIELD_MASK;
+    uint64_t textures = textureSet & FIELD_MASK;
+    uint64_t vertexArray = (draw.vertexArray ? draw.vertexArray->GetRendererID() : 0) & FIELD_MASK;
+
+    if (draw.pass == Pass::TRANSLUCENT)
+    {
+        uint64_t depth = DEPTH_MASK - QuantizeDepth(draw.depth);
+        return pass << 60 | depth << 36 | program << 24 | textures << 12 | vertexArray;
+    }
+    uint64_t depth = QuantizeDepth(draw.depth);
+    return pass << 60 | program << 48 | textures << 36 | vertexArray << 24 | depth;
+}
+
+void Renderer::Submit(const Draw& draw, std::initializer_list<Uniform> uniforms)
+{
+    ASSERT(draw.indexBuffer);
+    const IndexBuffer& ib = *draw.indexBuffer;
+
+    Command command;
+    command.program = draw.program;
+    command.vertexArray = draw.vertexArray ? draw.vertexArray->GetRendererID() : 0;
+    command.indexBuffer = ib.GetRendererID();
+    command.indexType = ib.GetType();
+    command.indexCount = draw.indexCount ? draw.indexCount : ib.GetCount();
+    command.indexOffset = ib.GetOffset();
+    command.baseVertex = draw.baseVertex;
+    command.instanceCount = draw.instanceCount;
+    command.textureSet = InternTextureSet(draw);
+    command.firstUniform = (unsigned int)m_Uniforms.size();
+    command.uniformCount = (unsigned int)uniforms.size();
+    m_Uniforms.insert(m_Uniforms.end(), uniforms.begin(), uniforms.end());
+
+    m_SortItems.push_back({MakeKey(draw, command.textureSet), (uint32_t)m_Commands.size()});
+    m_Commands.push_back(command);
+}
+
+unsigned int Renderer::CountUnsortedStateChanges() const
+{
+    unsigned int changes = 0;
+    const Command* previous = nullptr;
+    for (const Command& command : m_Commands)
+    {
+        changes += !previous || previous->program != command.program;
+        changes += !previous || previous->vertexArray != command.vertexArray;
+        changes += !previous || previous->textureSet != command.textureSet;
+        previous = &command;
+    }
+    return changes;
+}
+
+void Renderer::Execute(const Command& command, const Command* previous)
+{
+    GLStateCache& state = GLStateCache::Get();
+
+    if (!previous || previous->program != command.program)
+    {
+        state.UseProgram(command.program);
+        m_Stats.programChanges++;
+    }
+    if (!previous || previous->vertexArray != command.vertexArray)
+    {
+        state.BindVertexArray(command.vertexArray);
+        m_Stats.vertexArrayChanges++;
+    }
+    // Element array bindings are per VAO; the cache filters repeats.
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, command.indexBuffer);
+
+    if (!previous || previous->textureSet != command.textureSet)
+    {
+        const TextureSet& set = m_TextureSets[command.textureSet];
+        for (unsigned int unit = 0; unit < set.count; unit++)
+            state.BindTexture(unit, GL_TEXTURE_2D, set.textures[unit]);
+        m_Stats.textureSetChanges++;
+    }
+
+    for (unsigned int i = 0; i < command.uniformCount; i++)
+    {
+        const Uniform& uniform = m_Uniforms[command.firstUniform + i];
+        switch (uniform.type)
+        {
+            case Uniform::INT: GLCall(glUniform1i(uniform.location, uniform.i)); break;
+            case Uniform::FLOAT: GLCall(glUniform1f(uniform.location, uniform.f[0])); break;
+            case Uniform::VEC2: GLCall(glUniform2f(uniform.location, uniform.f[0], uniform.f[1])); break;
+            case Uniform::VEC3: GLCall(glUniform3f(uniform.location, uniform.f[0], uniform.f[1], uniform.f[2])); break;
+            case Uniform::VEC4: GLCall(glUniform4f(uniform.location, uniform.f[0], uniform.f[1], uniform.f[2], uniform.f[3])); break;
+            case Uniform::MAT4: GLCall(glUniformMatrix4fv(uniform.location, 1, GL_FALSE, uniform.f)); break;
+        }
+    }
+    m_Stats.uniformUpdates += command.uniformCount;
+
+    if (command.baseVertex == 0)
+    {
+        if (command.instanceCount == 1)
+            GLCall(glDrawElements(GL_TRIANGLES, command.indexCount, command.indexType, command.indexOffset));
+        else
+            GLCall(glDrawElementsInstanced(GL_TRIANGLES, command.indexCount, command.indexType, command.indexOffset,
+                                           command.instanceCount));
+    }
+    else
+    {
+        if (command.instanceCount == 1)
+            GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, command.indexCount, command.indexType, command.indexOffset,
+                                            command.baseVertex));
+        else
+            GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.indexCount, command.indexType,
+                                                     command.indexOffset, command.instanceCount, command.baseVertex));
+    }
+    m_Stats.draws++;
 }
-bool GLLogCall(const char* function, const char* file, int line)
+
+void Renderer::Flush()
 {
-    while(GLenum error = glGetError())
+    m_Stats = Stats();
+    if (!m_Commands.empty())
     {
-        std::cout << "[OpenGL Error] (" <<  error << "): " << function << " " << file << ";" << line << std::endl; 
-        return false;
+        m_Stats.unsortedStateChanges = CountUnsortedStateChanges();
+
+        auto start = Clock::now();
+        RadixSort(m_SortItems, m_SortScratch);
+        auto sorted = Clock::now();
+
+        const Command* previous = nullptr;
+        for (const SortItem& item : m_SortItems)
+        {
+            const Command& command = m_Commands[item.command];
+            Execute(command, previous);
+            previous = &command;
+        }
+        m_Stats.sortMs = std::chrono::duration<double, std::milli>(sorted - start).count();
+        m_Stats.executeMs = std::chrono::duration<double, std::milli>(Clock::now() - sorted).count();
     }
-    return true;
-}   
\ No newline at end of file
+
+    m_Commands.clear();
+    m_Uniforms.clear();
+    m_TextureSets.clear();
+    m_TextureSetLookup.clear();
+    m_SortItems.clear();
+}
+
+void Renderer::Report(std::ostream& out) const
+{
+    unsigned int sorted = m_Stats.programChanges + m_Stats.vertexArrayChanges + m_Stats.textureSetChanges;
+    out << "Renderer (last frame): " << m_Stats.draws << " draws, "
+        << m_Stats.programChanges << " program / " << m_Stats.vertexArrayChanges << " VAO / "
+        << m_Stats.textureSetChanges << " texture set changes (" << sorted << " sorted vs "
+        << m_Stats.unsortedStateChanges << " in submission order), "
+        << m_Stats.uniformUpdates << " uniform updates\n"
+        << "  sort " << std::fixed << std::setprecision(3) << m_Stats.sortMs << " ms, execute "
+        << m_Stats.executeMs << " ms" << std::endl;
+}
@@ -1,10 +1,139 @@
-#include "glad/glad.h"
+#pragma once
 
-#define ASSERT(x) if(!(x)) __debugbreak();
-#define GLCall(x) GLClearError();\
-    x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+// GL error checking (GLCall/ASSERT) lives in common/GLDebug.h.
+#include "GLDebug.h"
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
 
+class VertexArray;
+class IndexBuffer;
 
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
+// Sorted draw queue.
+//
+// Submit records a draw with everything it needs (program, VAO, index
+// buffer, textures, uniform values) and a 64-bit sort key. Flush radix-sorts
+// the keys and executes the draws, binding through the GLStateCache, so draws
+// sharing a program, texture set and VAO run back to back:
+//
+//   SOLID / OVERLAY  pass:4 | program:12 | textures:12 | vertex array:12 | depth:24 (front to back)
+//   TRANSLUCENT      pass:4 | depth:24 (back to front) | program:12 | textures:12 | vertex array:12
+//
+// Program and VAO fields are the low bits of the GL names, which are small
+// and allocated in order; a collision only costs grouping, never correctness.
+// Pointers in a submitted draw must stay valid until Flush.
+class Renderer
+{
+    public:
+        static constexpr unsigned int MAX_TEXTURE_UNITS = 8;
+
+        enum class Pass
+        {
+            SOLID, TRANSLUCENT, OVERLAY
+        };
+
+        struct Uniform
+        {
+            enum Type : uint8_t { INT, FLOAT, VEC2, VEC3, VEC4, MAT4 };
+
+            int location;
+            Type type;
+            union
+            {
+                int i;
+                float f[16];
+            };
+
+            static Uniform Int(int location, int value);
+            static Uniform Float(int location, float value);
+            static Uniform Vec2(int location, float x, float y);
+            static Uniform Vec3(int location, float x, float y, float z);
+            static Uniform Vec4(int location, float x, float y, float z, float w);
+            // Column major, like glUniformMatrix4fv without transpose.
+            static Uniform Mat4(int location, const float* values);
+        };
+
+        struct Draw
+        {
+            Pass pass = Pass::SOLID;
+            unsigned int program = 0;
+            const VertexArray* vertexArray = nullptr;
+            const IndexBuffer* indexBuffer = nullptr;
+            // 0 draws every index of indexBuffer.
+            unsigned int indexCount = 0;
+            int baseVertex = 0;
+            unsigned int instanceCount = 1;
+            // GL_TEXTURE_2D bound to units 0..textureCount-1.
+            unsigned int textures[MAX_TEXTURE_UNITS] = {};
+            unsigned int textureCount = 0;
+            // Normalised view depth, 0 near to 1 far.
+            float depth = 0.0f;
+        };
+
+        struct Stats
+        {
+            unsigned int draws = 0;
+            unsigned int programChanges = 0;
+            unsigned int vertexArrayChanges = 0;
+            unsigned int textureSetChanges = 0;
+            unsigned int uniformUpdates = 0;
+            // The same changes had the draws run in submission order.
+            unsigned int unsortedStateChanges = 0;
+            double sortMs = 0.0;
+            double executeMs = 0.0;
+        };
+
+    private:
+        struct Command
+        {
+            unsigned int program;
+            unsigned int vertexArray;
+            unsigned int indexBuffer;
+            unsigned int indexType;
+            unsigned int indexCount;
+            const void* indexOffset;
+            int baseVertex;
+            unsigned int instanceCount;
+            unsigned int textureSet;
+            unsigned int firstUniform;
+            unsigned int uniformCount;
+        };
+
+        struct TextureSet
+        {
+            unsigned int textures[MAX_TEXTURE_UNITS];
+            unsigned int count;
+        };
+
+        struct SortItem
+        {
+            uint64_t key;
+            uint32_t command;
+        };
+
+        std::vector<Command> m_Commands;
+        std::vector<Uniform> m_Uniforms;
+        std::vector<TextureSet> m_TextureSets;
+        // hash of the textures -> index into m_TextureSets
+        std::unordered_multimap<uint64_t, unsigned int> m_TextureSetLookup;
+        std::vector<SortItem> m_SortItems;
+        std::vector<SortItem> m_SortScratch;
+        Stats m_Stats;
+
+        unsigned int InternTextureSet(const Draw& draw);
+        static uint64_t MakeKey(const Draw& draw, unsigned int textureSet);
+        unsigned int CountUnsortedStateChanges() const;
+        void Execute(const Command& command, const Command* previous);
+
+    public:
+        void Submit(const Draw& draw, std::initializer_list<Uniform> uniforms = {});
+        // Sorts and executes everything submitted since the last Flush.
+        void Flush();
+
+        inline unsigned int GetPendingCount() const { return (unsigned int)m_Commands.size(); }
+        // Of the last Flush.
+        inline const Stats& GetStats() const { return m_Stats; }
+        void Report(std::ostream& out) const;
+};
@@ -0,0 +1,208 @@
+#include "ShaderReflection.h"
+#include "Renderer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    struct InputShape
+    {
+        unsigned int components;
+        unsigned int locations;
+        bool integer;
+    };
+
+    InputShape ShapeOf(unsigned int type)
+    {
+        switch (type)
+        {
+            case GL_FLOAT: return {1, 1, false};
+            case GL_FLOAT_VEC2: return {2, 1, false};
+            case GL_FLOAT_VEC3: return {3, 1, false};
+            case GL_FLOAT_VEC4: return {4, 1, false};
+            case GL_FLOAT_MAT2: return {2, 2, false};
+            case GL_FLOAT_MAT3: return {3, 3, false};
+            case GL_FLOAT_MAT4: return {4, 4, false};
+            case GL_FLOAT_MAT2x3: return {3, 2, false};
+            case GL_FLOAT_MAT2x4: return {4, 2, false};
+            case GL_FLOAT_MAT3x2: return {2, 3, false};
+            case GL_FLOAT_MAT3x4: return {4, 3, false};
+            case GL_FLOAT_MAT4x2: return {2, 4, false};
+            case GL_FLOAT_MAT4x3: return {3, 4, false};
+            case GL_INT: return {1, 1, true};
+            case GL_INT_VEC2: return {2, 1, true};
+            case GL_INT_VEC3: return {3, 1, true};
+            case GL_INT_VEC4: return {4, 1, true};
+            case GL_UNSIGNED_INT: return {1, 1, true};
+            case GL_UNSIGNED_INT_VEC2: return {2, 1, true};
+            case GL_UNSIGNED_INT_VEC3: return {3, 1, true};
+            case GL_UNSIGNED_INT_VEC4: return {4, 1, true};
+        }
+        // Doubles and anything newer: treat as one vec4 location.
+        return {4, 1, false};
+    }
+
+    bool IsRead(const std::vector<ShaderAttribute>& attributes, unsigned int location)
+    {
+        for (const ShaderAttribute& attribute : attributes)
+            if (attribute.location >= 0 && location >= (unsigned int)attribute.location &&
+                location < (unsigned int)attribute.location + attribute.locations)
+                return true;
+        return false;
+    }
+
+    const char* Per(const VertexArray::Attribute& attribute)
+    {
+        return attribute.divisor ? "instance" : "vertex";
+    }
+}
+
+std::vector<ShaderAttribute> ReflectAttributes(unsigned int program)
+{
+    std::vector<ShaderAttribute> attributes;
+    int count = 0;
+    int maxLength = 0;
+    GLCall(glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count));
+    GLCall(glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength));
+
+    std::vector<char> name(maxLength + 1);
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0;
+        int size = 0;
+        unsigned int type = 0;
+        GLCall(glGetActiveAttrib(program, (unsigned int)i, (int)name.size(), &length, &size, &type, name.data()));
+        if (std::strncmp(name.data(), "gl_", 3) == 0)
+            continue;
+
+        int location = glGetAttribLocation(program, name.data());
+        InputShape shape = ShapeOf(type);
+        attributes.push_back({std::string(name.data(), length), location, type, shape.components,
+                              shape.locations * (unsigned int)size, shape.integer});
+    }
+    std::sort(attributes.begin(), attributes.end(),
+              [](const ShaderAttribute& a, const ShaderAttribute& b) { return a.location < b.location; });
+    return attributes;
+}
+
+bool CheckVertexInputs(const std::vector<ShaderAttribute>& attributes, const VertexArray& va, std::ostream& out)
+{
+    const VertexArray::Attribute* fetched = va.GetAttributes();
+    const VertexArray::Attribute* fetchedEnd = fetched + va.GetFetchedCount();
+    auto find = [&](unsigned int location) -> const VertexArray::Attribute* {
+        for (const VertexArray::Attribute* attribute = fetched; attribute != fetchedEnd; attribute++)
+            if (attribute->location == location)
+                return attribute;
+        return nullptr;
+    };
+
+    unsigned int errors = 0;
+    for (const ShaderAttribute& input : attributes)
+    {
+        if (input.location < 0)
+            continue;
+        for (unsigned int l = 0; l < input.locations; l++)
+        {
+            unsigned int location = (unsigned int)input.location + l;
+            const VertexArray::Attribute* attribute = find(location);
+            if (!attribute)
+            {
+                out << "error: '" << input.name << "' (location " << location
+                    << ") has no vertex attribute and reads the current value\n";
+                errors++;
+                continue;
+            }
+            if (input.integer)
+            {
+                out << "error: '" << input.name << "' (location " << location
+                    << ") is an integer input but is fed converted floats\n";
+                errors++;
+            }
+            else if (attribute->count > input.components && !VertexBufferElement::IsPacked(attribute->type))
+            {
+                unsigned int wasted = (attribute->count - input.components) * VertexBufferElement::GetSizeOfType(attribute->type);
+                out << "warning: location " << location << " fetches " << attribute->count << " components, '"
+                    << input.name << "' reads " << input.components << ": " << wasted << " bytes per "
+                    << Per(*attribute) << " unused\n";
+            }
+            else if (attribute->count < input.components)
+            {
+                out << "note: '" << input.name << "' (location " << location << ") reads " << input.components
+                    << " components from " << attribute->count << ", the rest default to 0,0,0,1\n";
+            }
+        }
+    }
+
+    unsigned int fetchedBytes = 0;
+    unsigned int unusedBytes = 0;
+    for (unsigned int stream = 0; stream < va.GetStreamCount(); stream++)
+    {
+        bool streamRead = false;
+        bool streamFetched = false;
+        for (const VertexArray::Attribute* it = fetched; it != fetchedEnd; it++)
+        {
+            const VertexArray::Attribute& attribute = *it;
+            if (attribute.stream != stream)
+                continue;
+            streamFetched = true;
+            fetchedBytes += attribute.size;
+            if (IsRead(attributes, attribute.location))
+            {
+                streamRead = true;
+                continue;
+            }
+            unusedBytes += attribute.size;
+            out << "warning: location " << attribute.location << " (stream " << stream << ") is fetched but never read: "
+                << attribute.size << " bytes per " << Per(attribute) << "\n";
+        }
+        if (streamFetched && !streamRead)
+            out << "warning: stream " << stream << " is bound but none of its attributes are read\n";
+    }
+    if (unusedBytes)
+        out << unusedBytes << " of " << fetchedBytes << " fetched attribute bytes are never read; see StripUnusedAttributes\n";
+    out << std::flush;
+    return errors == 0;
+}
+
+VertexBufferLayout StripUnusedAttributes(const VertexBufferLayout& layout, unsigned int firstLocation,
+                                         const std::vector<ShaderAttribute>& attributes)
+{
+    VertexBufferLayout stripped;
+    const auto& elements = layout.GetElements();
+    for (unsigned int i = 0; i < elements.size(); i++)
+    {
+        if (elements[i].count != 0 && IsRead(attributes, firstLocation + i))
+            stripped.Push(elements[i]);
+        else
+            stripped.PushUnused();
+    }
+    return stripped;
+}
+
+void RepackVertices(const void* data, unsigned int vertexCount, const VertexBufferLayout& from,
+                    const VertexBufferLayout& to, void* out)
+{
+    const auto& source = from.GetElements();
+    const auto& kept = to.GetElements();
+    ASSERT(source.size() == kept.size());
+
+    const unsigned char* src = static_cast<const unsigned char*>(data);
+    unsigned char* dst = static_cast<unsigned char*>(out);
+    for (unsigned int v = 0; v < vertexCount; v++)
+    {
+        unsigned int srcOffset = 0;
+        unsigned int dstOffset = 0;
+        for (unsigned int i = 0; i < source.size(); i++)
+        {
+            unsigned int size = source[i].GetSize();
+            if (kept[i].count != 0)
+            {
+                std::memcpy(dst + dstOffset, src + srcOffset, size);
+                dstOffset += size;
+            }
+            srcOffset += size;
+        }
+        src += from.GetStride();
+        dst += to.GetStride();
+    }
+}
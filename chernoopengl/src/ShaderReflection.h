@@ -0,0 +1,46 @@
+#pragma once
+
+#include "VertexArray.h"
+#include "VertexBufferLayout.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Vertex inputs a linked program actually reads, from glGetActiveAttrib.
+// Inputs the compiler optimised away are not active and don't appear.
+struct ShaderAttribute
+{
+    std::string name;
+    int location;
+    unsigned int type;
+    // Components read per location; a matrix takes one location per column.
+    unsigned int components;
+    unsigned int locations;
+    // int/uint inputs need glVertexAttribIPointer, which VertexArray never uses.
+    bool integer;
+};
+
+// Sorted by location; built-ins such as gl_VertexID are skipped.
+std::vector<ShaderAttribute> ReflectAttributes(unsigned int program);
+
+// Compares what va fetches with what the program reads and writes one line
+// per finding to out:
+//   error   - an integer input, or an input no attribute feeds (it reads
+//             the constant current value instead)
+//   warning - an attribute or whole stream that is fetched but not read, or
+//             that has more components than the input uses
+//   note    - fewer components than the input, the rest filled with 0,0,0,1
+// Returns false if there were errors.
+bool CheckVertexInputs(const std::vector<ShaderAttribute>& attributes, const VertexArray& va, std::ostream& out);
+
+// Copy of layout, whose attributes start at firstLocation, with every
+// attribute the program doesn't read turned into a placeholder: locations
+// stay the same, the stride shrinks. Convert the vertex data with
+// RepackVertices.
+VertexBufferLayout StripUnusedAttributes(const VertexBufferLayout& layout, unsigned int firstLocation,
+                                         const std::vector<ShaderAttribute>& attributes);
+
+// Copies the attributes kept in to (same element order as from) out of
+// vertexCount vertices laid out as from.
+void RepackVertices(const void* data, unsigned int vertexCount, const VertexBufferLayout& from,
+                    const VertexBufferLayout& to, void* out);
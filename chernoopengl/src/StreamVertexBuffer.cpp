@@ -0,0 +1,116 @@
+#include "StreamVertexBuffer.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include "GLTrace.h"
+#include <algorithm>
+
+namespace
+{
+    bool HasBufferStorage()
+    {
+        bool supported = false;
+#if defined(GL_VERSION_4_4)
+        supported = supported || GLAD_GL_VERSION_4_4;
+#endif
+#if defined(GL_ARB_buffer_storage)
+        supported = supported || GLAD_GL_ARB_buffer_storage;
+#endif
+        return supported;
+    }
+}
+
+StreamVertexBuffer::StreamVertexBuffer(unsigned int regionSize, unsigned int regionCount)
+    : m_RegionSize(regionSize), m_RegionCount(std::min(std::max(regionCount, 1u), MAX_REGIONS)), m_Region(0),
+      m_Persistent(HasBufferStorage() && !GLTraceIsRecording()), m_PersistentBase(nullptr), m_Fences{}
+{
+    GLsizeiptr size = (GLsizeiptr)m_RegionSize * m_RegionCount;
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+    if (m_Persistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags));
+        GLCall(m_PersistentBase = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+        return;
+    }
+#endif
+    GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW));
+}
+
+StreamVertexBuffer::~StreamVertexBuffer()
+{
+    for (GLsync& fence : m_Fences)
+        if (fence)
+            GLCall(glDeleteSync(fence));
+    // Deleting a buffer implicitly unmaps it; the queue waits until the GPU
+    // is done with the last region.
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::BUFFER, m_RendererID);
+}
+
+void* StreamVertexBuffer::Map()
+{
+    if (m_Persistent)
+    {
+        // With three regions the fence has almost always signaled; only a
+        // GPU more than two frames behind makes this wait.
+        GLsync& fence = m_Fences[m_Region];
+        if (fence)
+        {
+            GLenum result;
+            GLbitfield flags = 0;
+            do
+            {
+                GLCall(result = glClientWaitSync(fence, flags, 1000000));
+                flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            } while (result == GL_TIMEOUT_EXPIRED);
+            GLCall(glDeleteSync(fence));
+            fence = nullptr;
+        }
+        return m_PersistentBase + GetOffset();
+    }
+
+    Bind();
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    if (m_Region == 0)
+    {
+        // Fresh storage on wrap-around; the GPU keeps reading the old one.
+        GLCall(glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)m_RegionSize * m_RegionCount, nullptr, GL_STREAM_DRAW));
+    }
+    void* pointer;
+    GLCall(pointer = glMapBufferRange(GL_ARRAY_BUFFER, GetOffset(), m_RegionSize, access));
+    return pointer;
+}
+
+void StreamVertexBuffer::Unmap()
+{
+    if (m_Persistent)
+        return;
+    Bind();
+    GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+}
+
+void StreamVertexBuffer::Fence()
+{
+    if (m_Persistent)
+    {
+        // A region fenced again without a Map in between still holds its
+        // previous sync; the new fence covers everything it did.
+        GLsync& fence = m_Fences[m_Region];
+        if (fence)
+            GLCall(glDeleteSync(fence));
+        GLCall(fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    }
+    m_Region = (m_Region + 1) % m_RegionCount;
+}
+
+void StreamVertexBuffer::Bind() const
+{
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+}
+void StreamVertexBuffer::Unbind() const
+{
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
+}
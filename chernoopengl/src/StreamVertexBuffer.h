@@ -0,0 +1,51 @@
+#pragma once
+
+#include "glad/glad.h"
+
+// Vertex buffer for geometry rewritten every frame.
+//
+// The buffer is split into regionCount regions used round-robin: the CPU
+// writes region N while the GPU may still read regions N-1 and N-2. With
+// GL 4.4 / ARB_buffer_storage the storage is immutable and persistently,
+// coherently mapped, and each region is guarded by a fence, so writing never
+// waits on the driver. On plain 3.3, or while a GLTrace is recording, the
+// whole buffer is orphaned each time the ring wraps and regions are mapped
+// unsynchronized instead.
+//
+//     void* vertices = stream.Map();   // write up to GetRegionSize() bytes
+//     stream.Unmap();
+//     draw with base vertex GetOffset() / stride
+//     stream.Fence();                  // after the last draw using the region
+class StreamVertexBuffer
+{
+    private:
+        static constexpr unsigned int MAX_REGIONS = 4;
+
+        unsigned int m_RendererID;
+        unsigned int m_RegionSize;
+        unsigned int m_RegionCount;
+        unsigned int m_Region;
+        bool m_Persistent;
+        char* m_PersistentBase;
+        GLsync m_Fences[MAX_REGIONS];
+
+    public:
+        StreamVertexBuffer(unsigned int regionSize, unsigned int regionCount = 3);
+        ~StreamVertexBuffer();
+
+        StreamVertexBuffer(const StreamVertexBuffer&) = delete;
+        StreamVertexBuffer& operator=(const StreamVertexBuffer&) = delete;
+
+        // Write pointer to the current region.
+        void* Map();
+        void Unmap();
+        // Marks the current region in use by the GPU and moves to the next.
+        void Fence();
+
+        void Bind() const;
+        void Unbind() const;
+
+        inline unsigned int GetOffset() const { return m_Region * m_RegionSize; }
+        inline unsigned int GetRegionSize() const { return m_RegionSize; }
+        inline bool IsPersistent() const { return m_Persistent; }
+};
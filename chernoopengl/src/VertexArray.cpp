@@ -1,37 +1,98 @@
 #include "VertexArray.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
 #include "VertexBufferLayout.h"
+#include <utility>
 
 VertexArray::VertexArray()
+    :m_AttributeCount(0), m_StreamCount(0), m_Attributes{}, m_FetchedCount(0)
 {
     GLCall(glGenVertexArrays(1, &m_RendererID));
 
 }
 VertexArray::~VertexArray()
 {
-    GLCall(glDeleteVertexArrays(1, &m_RendererID));
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::VERTEX_ARRAY, m_RendererID);
 }
 
-void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+VertexArray::VertexArray(VertexArray&& other) noexcept
+    :m_RendererID(other.m_RendererID), m_AttributeCount(other.m_AttributeCount), m_StreamCount(other.m_StreamCount),
+     m_Attributes(other.m_Attributes), m_FetchedCount(other.m_FetchedCount)
+{
+    other.m_RendererID = 0;
+    other.m_AttributeCount = 0;
+    other.m_StreamCount = 0;
+    other.m_FetchedCount = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+    if (this != &other)
+    {
+        GLDeletionQueue::Get().Delete(GLDeletionQueue::VERTEX_ARRAY, m_RendererID);
+        m_RendererID = other.m_RendererID;
+        m_AttributeCount = other.m_AttributeCount;
+        m_StreamCount = other.m_StreamCount;
+        m_Attributes = other.m_Attributes;
+        m_FetchedCount = other.m_FetchedCount;
+        other.m_RendererID = 0;
+        other.m_AttributeCount = 0;
+        other.m_StreamCount = 0;
+        other.m_FetchedCount = 0;
+    }
+    return *this;
+}
+
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor)
+{
+    Bind();
+    vb.Bind();
+    SetAttributes(layout, divisor);
+}
+
+void VertexArray::AddBuffer(const StreamVertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor)
 {
     Bind();
     vb.Bind();
+    SetAttributes(layout, divisor);
+}
+
+void VertexArray::SetAttributes(const VertexBufferLayout& layout, unsigned int divisor)
+{
     const auto& elements = layout.GetElements();
     unsigned int offset = 0;
     for (unsigned int i =0; i < elements.size(); i++) 
     {    
         const auto& element = elements[i];
-        GLCall(glEnableVertexAttribArray(i));
-        GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset));
-        offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+        unsigned int index = m_AttributeCount++;
+        if (element.count == 0)
+            continue;
+        SetAttribute(index, element.count, element.type, element.normalized, element.GetSize(), layout.GetStride(), offset, divisor);
+        offset += element.GetSize();
     }
+    m_StreamCount++;
+}
+
+void VertexArray::SetAttribute(unsigned int index, unsigned int count, unsigned int type, unsigned char normalized,
+                               unsigned int size, unsigned int stride, unsigned int offset, unsigned int divisor)
+{
+    ASSERT(index < MAX_ATTRIBUTES);
+    if (index >= MAX_ATTRIBUTES)
+        return;
+    m_Attributes[m_FetchedCount++] = {index, type, count, normalized, size, m_StreamCount, divisor};
+    GLCall(glEnableVertexAttribArray(index));
+    GLCall(glVertexAttribPointer(index, count, type, normalized, stride, (const void*)(size_t)offset));
+    // A new VAO starts with divisor 0 everywhere.
+    if (divisor)
+        GLCall(glVertexAttribDivisor(index, divisor));
 }
 
 void VertexArray::Bind() const
 {
-    GLCall(glBindVertexArray(m_RendererID));
+    GLStateCache::Get().BindVertexArray(m_RendererID);
 }
 void VertexArray::Unbind() const
 {
-    GLCall(glBindVertexArray(0));
+    GLStateCache::Get().BindVertexArray(0);
 }
\ No newline at end of file
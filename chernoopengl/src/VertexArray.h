@@ -1,19 +1,90 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "StreamVertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include <array>
+#include <utility>
 
-
+// Move only; the VAO is deleted through the GLDeletionQueue.
+//
+// Every AddBuffer adds a stream: its attributes take the next free
+// locations, so a second buffer (positions and normals kept apart, or
+// per-instance data) continues where the previous one stopped. Streams with
+// a divisor advance once every divisor instances instead of per vertex;
+// draw them with glDrawElementsInstanced.
 class VertexArray
 {
+    public:
+        // One enabled attribute, as fetched; see CheckVertexInputs.
+        struct Attribute
+        {
+            unsigned int location;
+            unsigned int type;
+            unsigned int count;
+            unsigned char normalized;
+            unsigned int size;
+            unsigned int stream;
+            unsigned int divisor;
+        };
+
     private:
+        // GL guarantees at least this many vertex attributes.
+        static constexpr unsigned int MAX_ATTRIBUTES = 16;
+
         unsigned int m_RendererID;
+        unsigned int m_AttributeCount;
+        unsigned int m_StreamCount;
+        // Fixed so AddBuffer never allocates; locations are unique, so
+        // MAX_ATTRIBUTES entries always suffice.
+        std::array<Attribute, MAX_ATTRIBUTES> m_Attributes;
+        unsigned int m_FetchedCount;
+
+        void SetAttributes(const VertexBufferLayout& layout, unsigned int divisor);
+        void SetAttribute(unsigned int index, unsigned int count, unsigned int type, unsigned char normalized,
+                          unsigned int size, unsigned int stride, unsigned int offset, unsigned int divisor);
+
+        template<size_t N, size_t... I>
+        void SetAttributes(const StaticVertexLayout<N>& layout, unsigned int divisor, std::index_sequence<I...>)
+        {
+            unsigned int first = m_AttributeCount;
+            (SetAttribute(first + (unsigned int)I, layout.attributes[I].count, layout.attributes[I].type,
+                          layout.attributes[I].normalized, layout.attributes[I].size, layout.stride,
+                          layout.attributes[I].offset, divisor), ...);
+            m_AttributeCount += (unsigned int)N;
+            m_StreamCount++;
+        }
 
     public:
         VertexArray();
         ~VertexArray();
 
-        void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+        VertexArray(const VertexArray&) = delete;
+        VertexArray& operator=(const VertexArray&) = delete;
+        VertexArray(VertexArray&& other) noexcept;
+        VertexArray& operator=(VertexArray&& other) noexcept;
+
+        void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor = 0);
+        // Attributes start at offset 0; draw each frame's region with a base
+        // vertex of vb.GetOffset() / layout.GetStride().
+        void AddBuffer(const StreamVertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor = 0);
+        // Layout from VERTEX_LAYOUT(Vertex, ...), expanded at compile time.
+        template<typename Vertex, typename Buffer>
+        void AddBuffer(const Buffer& vb, unsigned int divisor = 0)
+        {
+            constexpr const auto& layout = VertexLayoutOf<Vertex>::value;
+            Bind();
+            vb.Bind();
+            SetAttributes(layout, divisor, std::make_index_sequence<layout.size>());
+        }
+
+        // Also the location the next AddBuffer starts at.
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+        inline unsigned int GetAttributeCount() const { return m_AttributeCount; }
+        inline unsigned int GetStreamCount() const { return m_StreamCount; }
+        // GetFetchedCount() entries; locations without data are left out.
+        inline const Attribute* GetAttributes() const { return m_Attributes.data(); }
+        inline unsigned int GetFetchedCount() const { return m_FetchedCount; }
 
         void Bind() const;
         void Unbind() const;
@@ -0,0 +1,221 @@
+#include "VertexArrayCache.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include <iomanip>
+
+namespace
+{
+    bool HasSeparateFormat()
+    {
+        bool supported = false;
+#if defined(GL_VERSION_4_3)
+        supported = supported || GLAD_GL_VERSION_4_3;
+#endif
+#if defined(GL_ARB_vertex_attrib_binding)
+        supported = supported || GLAD_GL_ARB_vertex_attrib_binding;
+#endif
+        return supported;
+    }
+
+    // FNV-1a
+    size_t Combine(size_t hash, unsigned int value)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= (size_t)1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+bool VertexArrayCache::Attribute::operator==(const Attribute& other) const
+{
+    return type == other.type && count == other.count && normalized == other.normalized && offset == other.offset;
+}
+
+bool VertexArrayCache::Format::operator==(const Format& other) const
+{
+    if (hash != other.hash || attributeCount != other.attributeCount || stride != other.stride)
+        return false;
+    for (unsigned int i = 0; i < attributeCount; i++)
+        if (!(attributes[i] == other.attributes[i]))
+            return false;
+    return true;
+}
+
+VertexArrayCache::Format VertexArrayCache::MakeFormat(const VertexBufferLayout& layout)
+{
+    Format format;
+    const auto& elements = layout.GetElements();
+    ASSERT(elements.size() <= MAX_ATTRIBUTES);
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < elements.size() && i < MAX_ATTRIBUTES; i++)
+    {
+        const VertexBufferElement& element = elements[i];
+        format.attributes[i] = {element.type, element.count, element.normalized, offset};
+        offset += element.GetSize();
+        format.attributeCount++;
+    }
+    format.stride = layout.GetStride();
+    HashFormat(format);
+    return format;
+}
+
+void VertexArrayCache::HashFormat(Format& format)
+{
+    size_t hash = (size_t)14695981039346656037ull;
+    hash = Combine(hash, format.stride);
+    for (unsigned int i = 0; i < format.attributeCount; i++)
+    {
+        const Attribute& attribute = format.attributes[i];
+        hash = Combine(hash, attribute.type);
+        hash = Combine(hash, attribute.count | (unsigned int)attribute.normalized << 8);
+        hash = Combine(hash, attribute.offset);
+    }
+    format.hash = hash;
+}
+
+VertexArrayCache::VertexArrayCache()
+    : m_Detected(false), m_SeparateFormat(false)
+{
+}
+
+VertexArrayCache& VertexArrayCache::Get()
+{
+    static VertexArrayCache cache;
+    return cache;
+}
+
+VertexArrayCache::Entry& VertexArrayCache::Find(const Format& format, unsigned int vertexBuffer, unsigned int indexBuffer)
+{
+    m_Stats.lookups++;
+    size_t hash = format.hash;
+    if (!m_SeparateFormat)
+        hash = Combine(Combine(hash, vertexBuffer), indexBuffer);
+
+    auto range = m_Entries.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        Entry& entry = it->second;
+        if (entry.vertexBuffer == vertexBuffer && entry.indexBuffer == indexBuffer && entry.format == format)
+        {
+            m_Stats.hits++;
+            GLStateCache::Get().BindVertexArray(entry.vertexArray);
+            return entry;
+        }
+    }
+
+    Entry entry = {format, vertexBuffer, indexBuffer, 0, 0};
+    GLCall(glGenVertexArrays(1, &entry.vertexArray));
+    GLStateCache& state = GLStateCache::Get();
+    state.BindVertexArray(entry.vertexArray);
+    m_Stats.vertexArraysCreated++;
+
+    if (m_SeparateFormat)
+    {
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+        for (unsigned int i = 0; i < format.attributeCount; i++)
+        {
+            const Attribute& attribute = format.attributes[i];
+            if (attribute.count == 0)
+                continue;
+            GLCall(glEnableVertexAttribArray(i));
+            GLCall(glVertexAttribFormat(i, attribute.count, attribute.type, attribute.normalized, attribute.offset));
+            GLCall(glVertexAttribBinding(i, 0));
+        }
+#endif
+    }
+    else
+    {
+        state.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        for (unsigned int i = 0; i < format.attributeCount; i++)
+        {
+            const Attribute& attribute = format.attributes[i];
+            if (attribute.count == 0)
+                continue;
+            GLCall(glEnableVertexAttribArray(i));
+            GLCall(glVertexAttribPointer(i, attribute.count, attribute.type, attribute.normalized, format.stride,
+                                         (const void*)(size_t)attribute.offset));
+        }
+        if (indexBuffer)
+            state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    }
+    return m_Entries.emplace(hash, entry)->second;
+}
+
+void VertexArrayCache::Bind(const Format& format, const VertexBuffer& vb, const IndexBuffer* ib)
+{
+    if (!m_Detected)
+    {
+        m_SeparateFormat = HasSeparateFormat();
+        m_Detected = true;
+    }
+
+    unsigned int indexBuffer = ib ? ib->GetRendererID() : 0;
+    if (!m_SeparateFormat)
+    {
+        Find(format, vb.GetRendererID(), indexBuffer);
+        return;
+    }
+
+    Entry& entry = Find(format, 0, 0);
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+    if (entry.boundBuffer != vb.GetRendererID())
+    {
+        GLCall(glBindVertexBuffer(0, vb.GetRendererID(), 0, format.stride));
+        entry.boundBuffer = vb.GetRendererID();
+        m_Stats.vertexBufferBinds++;
+    }
+    else
+    {
+        m_Stats.vertexBufferBindsFiltered++;
+    }
+#endif
+    if (ib)
+        GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+}
+
+void VertexArrayCache::Bind(const VertexBufferLayout& layout, const VertexBuffer& vb, const IndexBuffer* ib)
+{
+    Bind(MakeFormat(layout), vb, ib);
+}
+
+void VertexArrayCache::OnDeleteBuffer(unsigned int buffer)
+{
+    if (buffer == 0)
+        return;
+    for (auto it = m_Entries.begin(); it != m_Entries.end();)
+    {
+        Entry& entry = it->second;
+        if (entry.boundBuffer == buffer)
+            entry.boundBuffer = 0;
+        // A recycled name must not hit a VAO that captured the old buffer.
+        if (entry.vertexBuffer == buffer || entry.indexBuffer == buffer)
+        {
+            GLDeletionQueue::Get().Delete(GLDeletionQueue::VERTEX_ARRAY, entry.vertexArray);
+            it = m_Entries.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
+void VertexArrayCache::Clear()
+{
+    for (auto& entry : m_Entries)
+        GLDeletionQueue::Get().Delete(GLDeletionQueue::VERTEX_ARRAY, entry.second.vertexArray);
+    m_Entries.clear();
+}
+
+void VertexArrayCache::Report(std::ostream& out) const
+{
+    out << "VAO cache: " << m_Entries.size() << " VAOs ("
+        << (m_SeparateFormat ? "one per format" : "per format and buffers") << "), "
+        << m_Stats.hits << "/" << m_Stats.lookups << " lookups hit, "
+        << m_Stats.vertexArraysCreated << " created\n";
+    if (m_SeparateFormat)
+        out << "  vertex buffer binds issued / filtered: " << m_Stats.vertexBufferBinds << " / " << m_Stats.vertexBufferBindsFiltered << "\n";
+    out << std::flush;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "IndexBuffer.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <unordered_map>
+
+// Shares VAOs between meshes with the same vertex format.
+//
+// With GL 4.3 / ARB_vertex_attrib_binding the format lives in the VAO
+// (glVertexAttribFormat) apart from the buffer (glBindVertexBuffer), so there
+// is one VAO per format and drawing another mesh of that format only
+// rebinds binding point 0. Before 4.3 attribute pointers capture the buffer,
+// so VAOs are keyed by format plus vertex and index buffer, which still
+// shares them between arena-backed meshes.
+//
+// Attributes always start at offset 0 of the buffer: draw arena meshes with
+// vb.GetBaseVertex(stride) as before. Buffer deletion must be reported
+// through OnDeleteBuffer (VertexBuffer, IndexBuffer and BufferArena do).
+// One interleaved stream per format; instanced or multi-stream setups use a
+// VertexArray.
+class VertexArrayCache
+{
+    public:
+        static constexpr unsigned int MAX_ATTRIBUTES = 16;
+
+        struct Stats
+        {
+            unsigned long long lookups = 0;
+            unsigned long long hits = 0;
+            unsigned long long vertexArraysCreated = 0;
+            unsigned long long vertexBufferBinds = 0;
+            unsigned long long vertexBufferBindsFiltered = 0;
+        };
+
+        struct Attribute
+        {
+            unsigned int type;
+            unsigned int count;
+            unsigned char normalized;
+            unsigned int offset;
+
+            bool operator==(const Attribute& other) const;
+        };
+
+        struct Format
+        {
+            std::array<Attribute, MAX_ATTRIBUTES> attributes;
+            unsigned int attributeCount = 0;
+            unsigned int stride = 0;
+            size_t hash = 0;
+
+            bool operator==(const Format& other) const;
+        };
+
+        static Format MakeFormat(const VertexBufferLayout& layout);
+        template<size_t N>
+        static Format MakeFormat(const StaticVertexLayout<N>& layout);
+
+    private:
+        struct Entry
+        {
+            Format format;
+            unsigned int vertexBuffer; // 0 with separate formats
+            unsigned int indexBuffer;  // 0 with separate formats
+            unsigned int vertexArray;
+            unsigned int boundBuffer;  // binding point 0, separate formats only
+        };
+
+        std::unordered_multimap<size_t, Entry> m_Entries;
+        bool m_Detected;
+        bool m_SeparateFormat;
+        Stats m_Stats;
+
+        VertexArrayCache();
+
+        static void HashFormat(Format& format);
+        Entry& Find(const Format& format, unsigned int vertexBuffer, unsigned int indexBuffer);
+
+    public:
+        static VertexArrayCache& Get();
+
+        // Binds a VAO for the format with vb (and ib, if given) attached.
+        void Bind(const Format& format, const VertexBuffer& vb, const IndexBuffer* ib = nullptr);
+        void Bind(const VertexBufferLayout& layout, const VertexBuffer& vb, const IndexBuffer* ib = nullptr);
+        // Layout from VERTEX_LAYOUT(Vertex, ...); the format is built once.
+        template<typename Vertex>
+        void Bind(const VertexBuffer& vb, const IndexBuffer* ib = nullptr)
+        {
+            static const Format format = MakeFormat(VertexLayoutOf<Vertex>::value);
+            Bind(format, vb, ib);
+        }
+
+        void OnDeleteBuffer(unsigned int buffer);
+        // Queues every VAO for deletion; call before GLDeletionQueue::Flush.
+        void Clear();
+
+        inline bool UsesSeparateFormat() const { return m_SeparateFormat; }
+        inline unsigned int GetVertexArrayCount() const { return (unsigned int)m_Entries.size(); }
+        inline const Stats& GetStats() const { return m_Stats; }
+        void ResetStats() { m_Stats = Stats(); }
+        void Report(std::ostream& out) const;
+};
+
+template<size_t N>
+VertexArrayCache::Format VertexArrayCache::MakeFormat(const StaticVertexLayout<N>& layout)
+{
+    static_assert(N <= MAX_ATTRIBUTES, "too many vertex attributes");
+    Format format;
+    for (size_t i = 0; i < N; i++)
+    {
+        const StaticVertexAttribute& attribute = layout.attributes[i];
+        format.attributes[i] = {attribute.type, attribute.count, attribute.normalized, attribute.offset};
+    }
+    format.attributeCount = (unsigned int)N;
+    format.stride = layout.stride;
+    HashFormat(format);
+    return format;
+}
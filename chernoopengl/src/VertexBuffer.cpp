@@ -1,22 +1,178 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
-VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include "VertexArrayCache.h"
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+    // Ranges closer than this are uploaded as one; a driver call costs
+    // more than copying a few hundred extra bytes.
+    constexpr unsigned int MERGE_GAP = 256;
+}
+
+VertexBuffer::VertexBuffer()
+    :m_RendererID(0), m_Size(0), m_Usage(GL_STATIC_DRAW), m_Arena(nullptr)
+{
+}
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, unsigned int usage)
+    :m_Size(size), m_Usage(usage), m_Arena(nullptr)
 {
     GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
-    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
-    
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
+    if (usage != GL_STATIC_DRAW)
+    {
+        m_Shadow.resize(size);
+        if (data)
+            std::memcpy(m_Shadow.data(), data, size);
+    }
+}
+VertexBuffer::VertexBuffer(BufferArena& arena, const void* data, unsigned int size, unsigned int stride)
+    :m_Size(size), m_Usage(GL_STATIC_DRAW), m_Arena(&arena), m_Allocation(arena.Allocate(data, size, stride))
+{
+    m_RendererID = m_Allocation.buffer;
 }
 VertexBuffer::~VertexBuffer()
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
+    Release();
+}
+
+VertexBuffer VertexBuffer::Adopt(unsigned int rendererID, unsigned int size)
+{
+    VertexBuffer vb;
+    vb.m_RendererID = rendererID;
+    vb.m_Size = size;
+    return vb;
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+    :m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_Usage(other.m_Usage), m_Arena(other.m_Arena),
+     m_Allocation(other.m_Allocation), m_Shadow(std::move(other.m_Shadow)), m_Dirty(std::move(other.m_Dirty)),
+     m_UpdateStats(other.m_UpdateStats)
+{
+    other.m_RendererID = 0;
+    other.m_Size = 0;
+    other.m_Arena = nullptr;
+    other.m_Dirty.Clear();
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        m_RendererID = other.m_RendererID;
+        m_Size = other.m_Size;
+        m_Usage = other.m_Usage;
+        m_Arena = other.m_Arena;
+        m_Allocation = other.m_Allocation;
+        m_Shadow = std::move(other.m_Shadow);
+        m_Dirty = std::move(other.m_Dirty);
+        m_UpdateStats = other.m_UpdateStats;
+        other.m_RendererID = 0;
+        other.m_Size = 0;
+        other.m_Arena = nullptr;
+        other.m_Dirty.Clear();
+    }
+    return *this;
+}
+
+void VertexBuffer::Release()
+{
+    if (m_Arena)
+    {
+        // The range may still be read by frames in flight.
+        m_Arena->DeferFree(m_Allocation);
+    }
+    else if (m_RendererID)
+    {
+        VertexArrayCache::Get().OnDeleteBuffer(m_RendererID);
+        GLDeletionQueue::Get().Delete(GLDeletionQueue::BUFFER, m_RendererID);
+    }
+    m_RendererID = 0;
+    m_Arena = nullptr;
+    m_Shadow.clear();
+    m_Dirty.Clear();
 }
 
 void VertexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 void VertexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexBuffer::Update(unsigned int offset, const void* data, unsigned int size)
+{
+    if (m_Shadow.empty() || offset + size > m_Size)
+    {
+        std::cerr << "VertexBuffer::Update: " << (m_Shadow.empty() ? "buffer is not dynamic" : "range out of bounds") << std::endl;
+        return;
+    }
+    std::memcpy(m_Shadow.data() + offset, data, size);
+    m_Dirty.Add(offset, size);
+}
+
+void VertexBuffer::MarkDirty(unsigned int offset, unsigned int size)
+{
+    if (!m_Shadow.empty() && offset + size <= m_Size)
+        m_Dirty.Add(offset, size);
+}
+
+void VertexBuffer::FlushUpdates(UpdateStrategy strategy)
+{
+    if (m_Dirty.IsEmpty())
+        return;
+    m_Dirty.Coalesce(MERGE_GAP);
+    const std::vector<DirtyRanges::Range>& ranges = m_Dirty.GetRanges();
+    unsigned int dirtyBytes = m_Dirty.GetDirtyBytes();
+
+    if (strategy == UpdateStrategy::AUTO)
+        strategy = dirtyBytes * 2 > m_Size ? UpdateStrategy::ORPHAN : UpdateStrategy::SUB_DATA;
+
+    // GL_COPY_WRITE_BUFFER leaves the GL_ARRAY_BUFFER binding alone.
+    GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+    switch (strategy)
+    {
+        case UpdateStrategy::ORPHAN:
+            GLCall(glBufferData(GL_COPY_WRITE_BUFFER, m_Size, m_Shadow.data(), m_Usage));
+            dirtyBytes = m_Size;
+            break;
+        case UpdateStrategy::MAP_UNSYNCHRONIZED:
+        {
+            unsigned int begin = ranges.front().begin;
+            unsigned int end = ranges.back().end;
+            GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+            unsigned char* mapped;
+            GLCall(mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, begin, end - begin, access));
+            if (mapped)
+            {
+                for (const DirtyRanges::Range& range : ranges)
+                {
+                    std::memcpy(mapped + range.begin - begin, m_Shadow.data() + range.begin, range.end - range.begin);
+                    GLCall(glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, range.begin - begin, range.end - range.begin));
+                }
+                GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+                break;
+            }
+            // Mapping failed; upload the ranges instead.
+        }
+        [[fallthrough]];
+        case UpdateStrategy::SUB_DATA:
+        default:
+            for (const DirtyRanges::Range& range : ranges)
+                GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, range.begin, range.end - range.begin, m_Shadow.data() + range.begin));
+            break;
+    }
+
+    m_UpdateStats.flushes++;
+    m_UpdateStats.ranges += strategy == UpdateStrategy::ORPHAN ? 1 : ranges.size();
+    m_UpdateStats.bytes += dirtyBytes;
+    m_Dirty.Clear();
+}
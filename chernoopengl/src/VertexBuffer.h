@@ -1,14 +1,85 @@
 #pragma once
 
+#include "BufferArena.h"
+#include "DirtyRanges.h"
+#include "glad/glad.h"
+#include <vector>
+
+// Owns its GL buffer (or arena range) and hands it to the GLDeletionQueue
+// when destroyed. Move only, so it can live in a HandlePool or vector.
+//
+// Buffers created with a usage other than GL_STATIC_DRAW (never arena
+// backed) keep a CPU copy of their contents. Update writes into that copy
+// and records the range; once per frame, before drawing, FlushUpdates
+// coalesces the ranges and uploads them in one of the ways below.
 class VertexBuffer
 {
+    public:
+    enum class UpdateStrategy
+    {
+        // ORPHAN when more than half the buffer is dirty, else SUB_DATA.
+        AUTO,
+        // One glBufferSubData per coalesced range.
+        SUB_DATA,
+        // glBufferData with the whole copy: fresh storage, no wait on draws
+        // still reading the old contents.
+        ORPHAN,
+        // One unsynchronized glMapBufferRange over all ranges, flushed per
+        // range. Only correct if the GPU is not reading the dirty ranges,
+        // e.g. they were not drawn from since the last fence.
+        MAP_UNSYNCHRONIZED
+    };
+
+    struct UpdateStats
+    {
+        unsigned long long flushes = 0;
+        unsigned long long ranges = 0;
+        unsigned long long bytes = 0;
+    };
+
     private:
     unsigned int m_RendererID;
+    unsigned int m_Size;
+    unsigned int m_Usage;
+    BufferArena* m_Arena;
+    BufferAllocation m_Allocation;
+    std::vector<unsigned char> m_Shadow;
+    DirtyRanges m_Dirty;
+    UpdateStats m_UpdateStats;
+
+    VertexBuffer();
+    void Release();
 
     public:
-    VertexBuffer(const void* data, unsigned int size);
+    VertexBuffer(const void* data, unsigned int size, unsigned int usage = GL_STATIC_DRAW);
+    // Sub-allocates from arena; stride keeps GetOffset() a whole vertex.
+    VertexBuffer(BufferArena& arena, const void* data, unsigned int size, unsigned int stride);
     ~VertexBuffer();
+    // Takes ownership of a size byte buffer filled elsewhere, e.g. by
+    // AsyncUploader. It has no CPU copy, so Update doesn't apply.
+    static VertexBuffer Adopt(unsigned int rendererID, unsigned int size);
+
+    VertexBuffer(const VertexBuffer&) = delete;
+    VertexBuffer& operator=(const VertexBuffer&) = delete;
+    VertexBuffer(VertexBuffer&& other) noexcept;
+    VertexBuffer& operator=(VertexBuffer&& other) noexcept;
 
     void Bind() const;
     void Unbind() const;
-};
\ No newline at end of file
+
+    // Copies size bytes to offset in the CPU copy; nothing reaches the GPU
+    // until FlushUpdates.
+    void Update(unsigned int offset, const void* data, unsigned int size);
+    // Contents of the CPU copy for in-place edits; call MarkDirty after.
+    inline unsigned char* GetData() { return m_Shadow.data(); }
+    void MarkDirty(unsigned int offset, unsigned int size);
+    void FlushUpdates(UpdateStrategy strategy = UpdateStrategy::AUTO);
+
+    inline unsigned int GetRendererID() const { return m_RendererID; }
+    inline unsigned int GetSize() const { return m_Size; }
+    inline const UpdateStats& GetUpdateStats() const { return m_UpdateStats; }
+
+    // Byte offset of the data inside the bound buffer; 0 unless arena backed.
+    inline unsigned int GetOffset() const { return m_Allocation.offset; }
+    inline unsigned int GetBaseVertex(unsigned int stride) const { return m_Allocation.offset / stride; }
+};
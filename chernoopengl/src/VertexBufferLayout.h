@@ -1,8 +1,39 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 #include <vector>
 // #include <glad/glad.h>
 #include "Renderer.h"
+#include "VertexEncoding.h"
+
+// GL description of one vertex component type. Types without a
+// specialization can't be pushed or used in a VERTEX_LAYOUT; the error names
+// the missing VertexAttribTraits<T>.
+template<typename T>
+struct VertexAttribTraits;
+
+template<unsigned int Type, unsigned char Normalized, unsigned int Size, bool Packed = false>
+struct VertexAttribTraitsBase
+{
+    static constexpr unsigned int type = Type;
+    static constexpr unsigned char normalized = Normalized;
+    // Per component, or of the whole attribute when packed.
+    static constexpr unsigned int size = Size;
+    static constexpr bool packed = Packed;
+};
+
+template<> struct VertexAttribTraits<float> : VertexAttribTraitsBase<GL_FLOAT, GL_FALSE, 4> {};
+template<> struct VertexAttribTraits<unsigned int> : VertexAttribTraitsBase<GL_UNSIGNED_INT, GL_FALSE, 4> {};
+template<> struct VertexAttribTraits<unsigned char> : VertexAttribTraitsBase<GL_UNSIGNED_BYTE, GL_TRUE, 1> {};
+// Packed formats; fill them with the encoders in VertexEncoding.h.
+template<> struct VertexAttribTraits<Half> : VertexAttribTraitsBase<GL_HALF_FLOAT, GL_FALSE, 2> {};
+template<> struct VertexAttribTraits<int16_t> : VertexAttribTraitsBase<GL_SHORT, GL_TRUE, 2> {};
+template<> struct VertexAttribTraits<uint16_t> : VertexAttribTraitsBase<GL_UNSIGNED_SHORT, GL_TRUE, 2> {};
+// Always four components; the shader reads w as well (0 if encoded from xyz).
+template<> struct VertexAttribTraits<Packed2_10_10_10> : VertexAttribTraitsBase<GL_INT_2_10_10_10_REV, GL_TRUE, 4, true> {};
 
 struct VertexBufferElement
 {
@@ -10,19 +41,38 @@ struct VertexBufferElement
     unsigned int count;
     unsigned char normalized;
 
+    // Per component, except for packed types where it covers all of them.
     static unsigned int GetSizeOfType(unsigned int type)
     {
-        switch (type) 
+        switch (type)
         {
             case GL_FLOAT: return 4;
             case GL_UNSIGNED_INT: return 4;
             case GL_UNSIGNED_BYTE: return 1;
+            case GL_HALF_FLOAT: return 2;
+            case GL_SHORT: return 2;
+            case GL_UNSIGNED_SHORT: return 2;
+            case GL_INT_2_10_10_10_REV: return 4;
         }
         ASSERT(false);
         return 0;
     }
+
+    static bool IsPacked(unsigned int type)
+    {
+        return type == GL_INT_2_10_10_10_REV;
+    }
+
+    // Placeholders (count 0) keep a location without storing anything.
+    inline unsigned int GetSize() const
+    {
+        if (count == 0)
+            return 0;
+        return IsPacked(type) ? GetSizeOfType(type) : count * GetSizeOfType(type);
+    }
 };
 
+// Layout built at runtime, one Push per attribute in order.
 class VertexBufferLayout
 {
     private:
@@ -35,31 +85,105 @@ class VertexBufferLayout
         template<typename T>
         void Push(unsigned int count)
         {
-            static_assert(false);
+            using Traits = VertexAttribTraits<T>;
+            if constexpr (Traits::packed)
+            {
+                ASSERT(count == 4);
+                m_Elements.push_back({Traits::type, 4, Traits::normalized});
+                m_Stride += Traits::size;
+            }
+            else
+            {
+                m_Elements.push_back({Traits::type, count, Traits::normalized});
+                m_Stride += count * Traits::size;
+            }
         }
 
-        template<>
-        void Push<float>(unsigned int count)
+        void Push(const VertexBufferElement& element)
         {
-            m_Elements.push_back({GL_FLOAT, count, GL_FALSE});
-            m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
+            m_Elements.push_back(element);
+            m_Stride += element.GetSize();
         }
 
-        template<>
-        void Push<unsigned int>(unsigned int count)
+        // Takes up the next location without storing or fetching anything,
+        // so the attributes after it keep theirs; see StripUnusedAttributes.
+        void PushUnused()
         {
-            m_Elements.push_back({GL_UNSIGNED_INT, count, GL_FALSE});
-            m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
-        }
-
-        template<>
-        void Push<unsigned char>(unsigned int count)
-        {
-            m_Elements.push_back({GL_UNSIGNED_BYTE, count, GL_TRUE});
-            m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
+            m_Elements.push_back({0, 0, GL_FALSE});
         }
 
         inline const std::vector<VertexBufferElement>& GetElements() const {return m_Elements; };
         inline unsigned int GetStride() const {return m_Stride;};
-        
-};
\ No newline at end of file
+
+};
+
+// Attribute of a StaticVertexLayout, with its offset resolved.
+struct StaticVertexAttribute
+{
+    unsigned int type;
+    unsigned int count;
+    unsigned char normalized;
+    unsigned int offset;
+    unsigned int size;
+
+    // Member is the declared type of the struct member: a supported scalar or
+    // an array of one, e.g. float[3] or Half[2].
+    template<typename Member>
+    static constexpr StaticVertexAttribute Of(size_t offset)
+    {
+        using Component = std::remove_all_extents_t<Member>;
+        using Traits = VertexAttribTraits<Component>;
+        constexpr unsigned int components = (unsigned int)(sizeof(Member) / sizeof(Component));
+        static_assert(std::rank_v<Member> <= 1, "vertex attributes are scalars or one-dimensional arrays");
+        static_assert(Traits::packed ? components == 1 : components >= 1 && components <= 4,
+                      "a vertex attribute has one to four components");
+        return {Traits::type, Traits::packed ? 4u : components, Traits::normalized, (unsigned int)offset, (unsigned int)sizeof(Member)};
+    }
+};
+
+// Layout of a vertex struct, computed at compile time; see VERTEX_LAYOUT.
+template<size_t N>
+struct StaticVertexLayout
+{
+    std::array<StaticVertexAttribute, N> attributes;
+    unsigned int stride;
+
+    static constexpr size_t size = N;
+
+    // Attributes in declaration order, none overlapping the next.
+    constexpr bool IsOrdered() const
+    {
+        for (size_t i = 1; i < N; i++)
+            if (attributes[i].offset < attributes[i - 1].offset + attributes[i - 1].size)
+                return false;
+        return true;
+    }
+};
+
+template<typename Vertex, typename... Attributes>
+constexpr StaticVertexLayout<sizeof...(Attributes)> MakeVertexLayout(Attributes... attributes)
+{
+    static_assert(std::is_standard_layout_v<Vertex>, "vertex structs must be standard layout");
+    return {{{attributes...}}, (unsigned int)sizeof(Vertex)};
+}
+
+// Maps a vertex struct to its layout; specialise with VERTEX_LAYOUT.
+template<typename Vertex>
+struct VertexLayoutOf;
+
+#define VERTEX_ATTRIBUTE(Vertex, member) \
+    StaticVertexAttribute::Of<decltype(Vertex::member)>(offsetof(Vertex, member))
+
+// At namespace scope, after the struct:
+//
+//     struct Vertex { float position[3]; Half uv[2]; };
+//     VERTEX_LAYOUT(Vertex, VERTEX_ATTRIBUTE(Vertex, position), VERTEX_ATTRIBUTE(Vertex, uv))
+//
+// then va.AddBuffer<Vertex>(vb).
+#define VERTEX_LAYOUT(Vertex, ...) \
+    template<> \
+    struct VertexLayoutOf<Vertex> \
+    { \
+        static constexpr auto value = MakeVertexLayout<Vertex>(__VA_ARGS__); \
+        static_assert(value.IsOrdered(), "list the attributes of " #Vertex " in declaration order"); \
+    };
@@ -0,0 +1,271 @@
+#include "VertexEncoding.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE4_1__)
+    #include <smmintrin.h>
+    #define ENCODE_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define ENCODE_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define ENCODE_NEON 1
+#endif
+#if defined(__F16C__)
+    #include <immintrin.h>
+#endif
+
+namespace
+{
+    // Float to half with round to nearest even, after F. Giesen's
+    // float_to_half_fast3_rtne; the SSE2 path below is the same algorithm
+    // with both branches computed and selected.
+    uint16_t FloatToHalf(float value)
+    {
+        const uint32_t f32Infinity = 255u << 23;
+        const uint32_t f16Max = (127u + 16u) << 23;
+        const uint32_t denormMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = bits & 0x80000000u;
+        bits ^= sign;
+
+        uint32_t result;
+        if (bits >= f16Max)
+        {
+            // Inf stays Inf, NaN becomes a quiet NaN.
+            result = bits > f32Infinity ? 0x7e00 : 0x7c00;
+        }
+        else if (bits < (113u << 23))
+        {
+            // Subnormal or zero: the FP add rounds the mantissa into place.
+            float f;
+            float magic;
+            std::memcpy(&f, &bits, sizeof(f));
+            std::memcpy(&magic, &denormMagic, sizeof(magic));
+            f += magic;
+            std::memcpy(&result, &f, sizeof(result));
+            result -= denormMagic;
+        }
+        else
+        {
+            uint32_t mantissaOdd = (bits >> 13) & 1;
+            bits += (uint32_t)(15 - 127) << 23;
+            bits += 0xfff + mantissaOdd;
+            result = bits >> 13;
+        }
+        return (uint16_t)(result | (sign >> 16));
+    }
+
+    int32_t QuantizeSnorm(float value, float scale)
+    {
+        return (int32_t)std::nearbyint(std::min(std::max(value, -1.0f), 1.0f) * scale);
+    }
+
+#if defined(ENCODE_SSE2)
+    __m128i FloatToHalf4(__m128 value)
+    {
+        const __m128i signMask = _mm_set1_epi32((int)0x80000000);
+        const __m128i f32Infinity = _mm_set1_epi32(255 << 23);
+        const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+        const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        const __m128i normalMin = _mm_set1_epi32(113 << 23);
+        const __m128i one = _mm_set1_epi32(1);
+
+        __m128i bits = _mm_castps_si128(value);
+        __m128i sign = _mm_and_si128(bits, signMask);
+        bits = _mm_xor_si128(bits, sign);
+
+        __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), one);
+        __m128i normal = _mm_add_epi32(bits, _mm_set1_epi32((int)(((uint32_t)(15 - 127) << 23) + 0xfff)));
+        normal = _mm_srli_epi32(_mm_add_epi32(normal, mantissaOdd), 13);
+
+        __m128 subnormalSum = _mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(denormMagic));
+        __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormalSum), denormMagic);
+
+        // The sign is cleared, so signed compares order the bit patterns.
+        __m128i nan = _mm_cmpgt_epi32(bits, f32Infinity);
+        __m128i special = _mm_or_si128(_mm_and_si128(nan, _mm_set1_epi32(0x7e00)), _mm_andnot_si128(nan, _mm_set1_epi32(0x7c00)));
+        __m128i isSpecial = _mm_cmpgt_epi32(bits, _mm_sub_epi32(f16Max, one));
+        __m128i isSubnormal = _mm_cmplt_epi32(bits, normalMin);
+
+        __m128i result = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+        result = _mm_or_si128(_mm_and_si128(isSpecial, special), _mm_andnot_si128(isSpecial, result));
+        return _mm_or_si128(result, _mm_srli_epi32(sign, 16));
+    }
+
+    // Packs the low 16 bits of each lane; packs_epi32 saturates, so sign
+    // extend first to make every value fit.
+    __m128i Pack16(__m128i low, __m128i high)
+    {
+        low = _mm_srai_epi32(_mm_slli_epi32(low, 16), 16);
+        high = _mm_srai_epi32(_mm_slli_epi32(high, 16), 16);
+        return _mm_packs_epi32(low, high);
+    }
+#endif
+}
+
+void EncodeHalf(const float* data, unsigned int count, Half* out)
+{
+    unsigned int i = 0;
+
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low = _mm_cvtps_ph(_mm_loadu_ps(data + i), _MM_FROUND_TO_NEAREST_INT);
+        __m128i high = _mm_cvtps_ph(_mm_loadu_ps(data + i + 4), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi64(low, high));
+    }
+#elif defined(ENCODE_SSE2)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low = FloatToHalf4(_mm_loadu_ps(data + i));
+        __m128i high = FloatToHalf4(_mm_loadu_ps(data + i + 4));
+        _mm_storeu_si128((__m128i*)(out + i), Pack16(low, high));
+    }
+#elif defined(ENCODE_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        float16x8_t halves = vcombine_f16(vcvt_f16_f32(vld1q_f32(data + i)), vcvt_f16_f32(vld1q_f32(data + i + 4)));
+        vst1q_u16((uint16_t*)(out + i), vreinterpretq_u16_f16(halves));
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i].bits = FloatToHalf(data[i]);
+}
+
+void EncodeSnorm16(const float* data, unsigned int count, int16_t* out)
+{
+    unsigned int i = 0;
+
+#if defined(ENCODE_SSE2)
+    const __m128 minimum = _mm_set1_ps(-1.0f);
+    const __m128 maximum = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        // cvtps rounds to nearest even under the default MXCSR.
+        __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), minimum), maximum), scale));
+        __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i + 4), minimum), maximum), scale));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(low, high));
+    }
+#elif defined(ENCODE_NEON)
+    const float32x4_t minimum = vdupq_n_f32(-1.0f);
+    const float32x4_t maximum = vdupq_n_f32(1.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        int32x4_t low = vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(data + i), minimum), maximum), 32767.0f));
+        int32x4_t high = vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(data + i + 4), minimum), maximum), 32767.0f));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = (int16_t)QuantizeSnorm(data[i], 32767.0f);
+}
+
+void EncodeUnorm16(const float* data, unsigned int count, uint16_t* out)
+{
+    unsigned int i = 0;
+
+#if defined(ENCODE_SSE2)
+    const __m128 minimum = _mm_setzero_ps();
+    const __m128 maximum = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), minimum), maximum), scale));
+        __m128i high = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i + 4), minimum), maximum), scale));
+        _mm_storeu_si128((__m128i*)(out + i), Pack16(low, high));
+    }
+#elif defined(ENCODE_NEON)
+    const float32x4_t minimum = vdupq_n_f32(0.0f);
+    const float32x4_t maximum = vdupq_n_f32(1.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        uint32x4_t low = vcvtnq_u32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(data + i), minimum), maximum), 65535.0f));
+        uint32x4_t high = vcvtnq_u32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(data + i + 4), minimum), maximum), 65535.0f));
+        vst1q_u16(out + i, vcombine_u16(vmovn_u32(low), vmovn_u32(high)));
+    }
+#endif
+
+    for (; i < count; i++)
+        out[i] = (uint16_t)std::nearbyint(std::min(std::max(data[i], 0.0f), 1.0f) * 65535.0f);
+}
+
+void EncodeSnorm2_10_10_10(const float* data, unsigned int vertexCount, unsigned int components, Packed2_10_10_10* out)
+{
+    unsigned int i = 0;
+
+#if defined(ENCODE_SSE2)
+    // Four vertices at a time, transposed so each register holds one
+    // component. With three components the last load reads one float past
+    // the fourth vertex, so keep a vertex of slack.
+    const __m128 minimum = _mm_set1_ps(-1.0f);
+    const __m128 maximum = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(511.0f);
+    const __m128i mask10 = _mm_set1_epi32(0x3ff);
+    for (; (components == 3 || components == 4) && i + 4 + (components == 3) <= vertexCount; i += 4)
+    {
+        const float* v = data + i * components;
+        __m128 x = _mm_loadu_ps(v);
+        __m128 y = _mm_loadu_ps(v + components);
+        __m128 z = _mm_loadu_ps(v + components * 2);
+        __m128 w = _mm_loadu_ps(v + components * 3);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        __m128i xi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, minimum), maximum), scale));
+        __m128i yi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, minimum), maximum), scale));
+        __m128i zi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, minimum), maximum), scale));
+        __m128i packed = _mm_or_si128(_mm_and_si128(xi, mask10),
+                         _mm_or_si128(_mm_slli_epi32(_mm_and_si128(yi, mask10), 10),
+                                      _mm_slli_epi32(_mm_and_si128(zi, mask10), 20)));
+        if (components == 4)
+        {
+            __m128i wi = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(w, minimum), maximum));
+            packed = _mm_or_si128(packed, _mm_slli_epi32(wi, 30));
+        }
+        _mm_storeu_si128((__m128i*)(out + i), packed);
+    }
+#elif defined(ENCODE_NEON)
+    const float32x4_t minimum = vdupq_n_f32(-1.0f);
+    const float32x4_t maximum = vdupq_n_f32(1.0f);
+    const uint32x4_t mask10 = vdupq_n_u32(0x3ff);
+    for (; (components == 3 || components == 4) && i + 4 <= vertexCount; i += 4)
+    {
+        float32x4_t x, y, z, w = vdupq_n_f32(0.0f);
+        if (components == 4)
+        {
+            float32x4x4_t v = vld4q_f32(data + i * 4);
+            x = v.val[0]; y = v.val[1]; z = v.val[2]; w = v.val[3];
+        }
+        else
+        {
+            float32x4x3_t v = vld3q_f32(data + i * 3);
+            x = v.val[0]; y = v.val[1]; z = v.val[2];
+        }
+        uint32x4_t xi = vreinterpretq_u32_s32(vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(x, minimum), maximum), 511.0f)));
+        uint32x4_t yi = vreinterpretq_u32_s32(vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(y, minimum), maximum), 511.0f)));
+        uint32x4_t zi = vreinterpretq_u32_s32(vcvtnq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(z, minimum), maximum), 511.0f)));
+        uint32x4_t wi = vreinterpretq_u32_s32(vcvtnq_s32_f32(vminq_f32(vmaxq_f32(w, minimum), maximum)));
+        uint32x4_t packed = vorrq_u32(vandq_u32(xi, mask10),
+                            vorrq_u32(vshlq_n_u32(vandq_u32(yi, mask10), 10),
+                            vorrq_u32(vshlq_n_u32(vandq_u32(zi, mask10), 20), vshlq_n_u32(wi, 30))));
+        vst1q_u32((uint32_t*)(out + i), packed);
+    }
+#endif
+
+    for (; i < vertexCount; i++)
+    {
+        const float* v = data + i * components;
+        uint32_t x = (uint32_t)QuantizeSnorm(v[0], 511.0f) & 0x3ff;
+        uint32_t y = (uint32_t)QuantizeSnorm(v[1], 511.0f) & 0x3ff;
+        uint32_t z = (uint32_t)QuantizeSnorm(v[2], 511.0f) & 0x3ff;
+        uint32_t w = components == 4 ? (uint32_t)QuantizeSnorm(v[3], 1.0f) & 0x3 : 0;
+        out[i].bits = x | (y << 10) | (z << 20) | (w << 30);
+    }
+}
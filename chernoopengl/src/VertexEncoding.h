@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// Packed vertex attribute storage and the encoders that quantize float
+// streams into it. Push<T> in VertexBufferLayout picks the matching GL type:
+//
+//   Half               GL_HALF_FLOAT                 2 bytes/component
+//   int16_t            GL_SHORT, normalized          2 bytes/component
+//   uint16_t           GL_UNSIGNED_SHORT, normalized 2 bytes/component
+//   Packed2_10_10_10   GL_INT_2_10_10_10_REV, normalized, 4 bytes for xyzw
+//
+// Encoders use F16C/SSE4.1/SSE2 on x86, NEON on AArch64, scalar elsewhere.
+// Rounding is to nearest even; out-of-range inputs clamp.
+
+struct Half
+{
+    uint16_t bits;
+};
+
+struct Packed2_10_10_10
+{
+    uint32_t bits;
+};
+
+void EncodeHalf(const float* data, unsigned int count, Half* out);
+// Snorm: [-1, 1] -> [-32767, 32767].
+void EncodeSnorm16(const float* data, unsigned int count, int16_t* out);
+// Unorm: [0, 1] -> [0, 65535].
+void EncodeUnorm16(const float* data, unsigned int count, uint16_t* out);
+// components (3 or 4) floats per vertex, e.g. normals or tangents with a
+// handedness sign in w. x, y, z get 10 signed bits, w 2; w is 0 for 3.
+void EncodeSnorm2_10_10_10(const float* data, unsigned int vertexCount, unsigned int components, Packed2_10_10_10* out);
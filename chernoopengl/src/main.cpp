@@ -1,17 +1,76 @@
 // #include <GL/gl.h>
 #include "VertexBufferLayout.h"
 #include "glad/glad.h"
-#include <GLFW/glfw3.h>
 #include <cassert>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 
 #include "Renderer.h"
+#include "GLContext.h"
+#include "FrameBenchmark.h"
+#include "GLTrace.h"
+#include "GpuProfiler.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
+#include "ShaderReflection.h"
+#include "FramePipeline.h"
+#include "UniformRing.h"
+#include "HandlePool.h"
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+struct Vertex
+{
+    float position[2];
+};
+VERTEX_LAYOUT(Vertex, VERTEX_ATTRIBUTE(Vertex, position))
+
+// Per-copy data of the instanced quad: xy offset and scale.
+struct Instance
+{
+    float offsetScale[3];
+};
+VERTEX_LAYOUT(Instance, VERTEX_ATTRIBUTE(Instance, offsetScale))
+
+// Per-frame parameters; matches the FrameUniforms block in Basic.shader.
+struct FrameUniforms
+{
+    Std140Vec4 u_Color;
+};
+UNIFORM_BLOCK(FrameUniforms, UNIFORM_MEMBER(FrameUniforms, u_Color))
+
+// GPU data of one drawable, owned by the mesh pool and addressed by handle.
+struct Mesh
+{
+    VertexArray va;
+    VertexBuffer vb;
+    VertexBuffer instanceVb;
+    IndexBuffer ib;
+};
+
+struct MeshDraw
+{
+    Handle<Mesh> mesh;
+    unsigned int instanceCount;
+};
+
+// One frame as the simulation thread hands it to the render thread. Draws
+// name meshes by handle; the render thread resolves them when submitting,
+// so a mesh destroyed meanwhile is skipped instead of dangling.
+struct FramePacket
+{
+    FrameUniforms uniforms;
+    std::vector<MeshDraw> draws;
+};
+
 struct ShaderProgramSource
 {
     std::string VertexSource;
@@ -89,106 +148,174 @@ static unsigned int CreateShader(const std::string& vertexShader, const std::str
     return program;
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
-    GLFWwindow* window;
-
-    /* Initialize the library */
-    if (!glfwInit())
-        return -1;
-
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    /* Create a windowed mode window and its OpenGL context */
-    window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
-    if (!window)
+    GLContextDesc desc;
+    desc.width = 640;
+    desc.height = 480;
+    desc.title = "Hello World";
+    desc.debug = GL_DEBUG_POLICY == GL_DEBUG_POLICY_ASYNC;
+
+    /* --instances N sets how many copies of the quad the single draw renders */
+    unsigned int instanceCount = 40000;
+    /* --frame-slots N: 2 double buffers the simulation, 3 triple buffers it */
+    unsigned int frameSlots = 2;
+    for (int i = 1; i + 1 < argc; i++)
     {
-        glfwTerminate();
-        return -1;
+        if (std::strcmp(argv[i], "--instances") == 0)
+            instanceCount = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--frame-slots") == 0)
+            frameSlots = (unsigned int)std::atoi(argv[++i]);
     }
 
-    /* Make the window's context current */
-    glfwMakeContextCurrent(window);
-
-    glfwSwapInterval(1);
+    /* --frames N [--warmup M] [--json out.json] runs a fixed-length benchmark */
+    FrameBenchmark benchmark(FrameBenchmarkDesc::FromArgs(argc, argv, "chernoopengl"));
+    GLContextDesc contextDesc = GLContextDesc::FromArgs(argc, argv, desc);
+    if (benchmark.IsEnabled())
+        contextDesc.maxFrames = benchmark.GetTotalFrames();
 
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD \n";
+    /* Create a window (or a headless context with --headless) and make it current */
+    std::unique_ptr<GLContext> context = GLContext::Create(contextDesc);
+    if (!context)
         return -1;
-    }
-
-    float positions[] = {
-        -0.5f, -0.5f,
-         0.5f,  -0.5f,
-         0.5f, 0.5f,
-        -0.5f, 0.5f
-    };
 
-    unsigned int indices[] = 
-    {
-        0, 1, 2,
-        2, 3, 0
-    };
+    if (!context->LoadGL())
+        return -1;
+    GLDebugInit();
 
-    unsigned int vao;
-    GLCall(glGenVertexArrays(1,&vao));
-    GLCall(glBindVertexArray(vao));
+    if (const char* tracePath = std::getenv("GL_TRACE_FILE"))
+        GLTraceBegin(tracePath);
 
-    VertexArray va;
-    VertexBuffer vb(positions, 4 * 2 * sizeof(float));
-    
-    VertexBufferLayout layout;
-    // layout.Push<float>(3);
-    // layout.Push<float>(3);
-    layout.Push<float>(2);
-    va.AddBuffer(vb,layout);
-
-    IndexBuffer ib(indices, 6);
-
-    ShaderProgramSource source = ParseShader("../res/shaders/Basic.shader");
-
-    unsigned int shader = CreateShader(source.VertexSource, source.FragmentSource);
-    GLCall(glUseProgram(shader));
-
-    int location = glGetUniformLocation(shader, "u_Color");
-    ASSERT(location != -1);
-    GLCall(glUniform4f(location, 0.8, 0.3, 0.8, 1.0));
-
-    GLCall(glBindVertexArray(0));
-    GLCall(glUseProgram(0));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-
-    float r = 0.0f;
-    float increment = 0.05f;
-    /* Loop until the user closes the window */
-    while (!glfwWindowShouldClose(window))
     {
-        GLCall(glClear(GL_COLOR_BUFFER_BIT));
-
-        GLCall(glUseProgram(shader));
-        GLCall(glUniform4f(location, r, 0.3f, 0.8f, 1.0f));
-            
-        va.Bind();
-        ib.Bind();
-
-        GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
+        Vertex vertices[] = {
+            {{-0.5f, -0.5f}},
+            {{ 0.5f,  -0.5f}},
+            {{ 0.5f, 0.5f}},
+            {{-0.5f, 0.5f}}
+        };
+
+        unsigned int indices[] = 
+        {
+            0, 1, 2,
+            2, 3, 0
+        };
+
+        unsigned int vao;
+        GLCall(glGenVertexArrays(1,&vao));
+        GLStateCache::Get().BindVertexArray(vao);
+
+        /* The copies tile the viewport in a square grid */
+        unsigned int side = (unsigned int)std::ceil(std::sqrt((double)instanceCount));
+        float cell = 2.0f / (float)(side ? side : 1);
+        std::vector<Instance> instances(instanceCount);
+        for (unsigned int i = 0; i < instanceCount; i++)
+        {
+            instances[i].offsetScale[0] = -1.0f + cell * ((float)(i % side) + 0.5f);
+            instances[i].offsetScale[1] = -1.0f + cell * ((float)(i / side) + 0.5f);
+            instances[i].offsetScale[2] = cell * 0.8f;
+        }
 
-        if(r > 1.0f) increment = -0.05f;
-        else if(r < 0.0f) increment = 0.05f;
+        HandlePool<Mesh> meshes;
+        Mesh quad = {VertexArray(), VertexBuffer(vertices, sizeof(vertices)),
+                     VertexBuffer(instances.data(), (unsigned int)(instances.size() * sizeof(Instance))),
+                     IndexBuffer(indices, 6)};
+        quad.va.AddBuffer<Vertex>(quad.vb);
+        quad.va.AddBuffer<Instance>(quad.instanceVb, 1);
+
+        ShaderProgramSource source = ParseShader("../res/shaders/Basic.shader");
+
+        unsigned int shader = CreateShader(source.VertexSource, source.FragmentSource);
+        /* Catch layouts that don't match what the vertex shader reads */
+        ASSERT(CheckVertexInputs(ReflectAttributes(shader), quad.va, std::cout));
+        Handle<Mesh> quadMesh = meshes.Create(std::move(quad));
+        GLStateCache::Get().UseProgram(shader);
+
+        ASSERT(UniformBindings::Get().Attach(shader, "FrameUniforms"));
+        unsigned int frameBinding = UniformBindings::Get().GetBinding("FrameUniforms");
+
+        GLStateCache::Get().BindVertexArray(0);
+        GLStateCache::Get().UseProgram(0);
+        GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
+        GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        float r = 0.0f;
+        float increment = 0.05f;
+        Renderer renderer;
+        UniformRing uniforms(sizeof(FrameUniforms));
+
+        /* Frame N is simulated on its own thread while frame N-1 is submitted here */
+        FramePipeline<FramePacket> pipeline([&](FramePacket& packet, unsigned long long) {
+            packet.uniforms.u_Color = {r, 0.3f, 0.8f, 1.0f};
+            packet.draws.clear();
+            packet.draws.push_back({quadMesh, instanceCount});
+
+            if(r > 1.0f) increment = -0.05f;
+            else if(r < 0.0f) increment = 0.05f;
+
+            r += increment;
+        }, frameSlots);
+
+        /* Loop until the user closes the window */
+        GpuProfiler profiler;
+        while (!context->ShouldClose())
+        {
+            benchmark.BeginFrame();
+            const FramePacket* packet = pipeline.Acquire();
+            profiler.BeginFrame();
+            {
+                GpuZone zone(profiler, "clear");
+                GLCall(glClear(GL_COLOR_BUFFER_BIT));
+            }
+            /* All of the frame's uniforms go up in one write */
+            uniforms.Begin();
+            unsigned int frameOffset = uniforms.Push(packet->uniforms);
+            uniforms.End();
+            uniforms.Bind<FrameUniforms>(frameBinding, frameOffset);
+            /* Pool pointers stay valid until Flush; nothing is created or destroyed in between */
+            for (const MeshDraw& meshDraw : packet->draws)
+            {
+                const Mesh* mesh = meshes.Get(meshDraw.mesh);
+                if (!mesh)
+                    continue;
+                Renderer::Draw draw;
+                draw.program = shader;
+                draw.vertexArray = &mesh->va;
+                draw.indexBuffer = &mesh->ib;
+                draw.instanceCount = meshDraw.instanceCount;
+                renderer.Submit(draw);
+            }
+            {
+                GpuZone zone(profiler, "draw");
+                renderer.Flush();
+            }
+            pipeline.Release();
+            profiler.EndFrame();
+
+            GLDeletionQueue::Get().EndFrame();
+            GLTraceFrame();
+            /* Swap front and back buffers */
+            benchmark.BeginSwap();
+            context->SwapBuffers();
+            benchmark.EndFrame(profiler.GetLastFrameGpuMs());
+
+            /* Poll for and process events */
+            context->PollEvents();
+        }
 
-        r += increment;
-        /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+        if (benchmark.IsEnabled())
+            benchmark.Finish(std::cout);
+        profiler.Report(std::cout);
+        GLStateCache::Get().Report(std::cout);
+        renderer.Report(std::cout);
+        pipeline.Report(std::cout);
+        uniforms.Report(std::cout);
 
-        /* Poll for and process events */
-        glfwPollEvents();
+        GLDeletionQueue::Get().Delete(GLDeletionQueue::VERTEX_ARRAY, vao);
+        GLDeletionQueue::Get().Delete(GLDeletionQueue::PROGRAM, shader);
     }
+    /* GL objects above were queued for deletion; release them while the context exists */
+    GLDeletionQueue::Get().Flush();
+    GLTraceEnd();
 
-    GLCall(glDeleteProgram(shader));
-
-    glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "AsyncUploader.h"
+#include "GLDebug.h"
+#include "GLStateCache.h"
+#include <iostream>
+
+namespace
+{
+    bool HasSync()
+    {
+        bool supported = false;
+#if defined(GL_VERSION_3_2)
+        supported = supported || GLAD_GL_VERSION_3_2;
+#endif
+#if defined(GL_ARB_sync)
+        supported = supported || GLAD_GL_ARB_sync;
+#endif
+        return supported;
+    }
+}
+
+AsyncUploader::AsyncUploader(GLContext& context)
+    : m_Busy(false), m_Stop(false), m_Pending(0), m_UploadedBytes(0)
+{
+    // Completion is signaled with fences; without them stay synchronous.
+    if (!HasSync())
+        return;
+    m_Context = context.CreateSharedContext();
+    if (!m_Context)
+    {
+        std::cerr << "AsyncUploader: no shared context, uploading synchronously" << std::endl;
+        return;
+    }
+    m_Thread = std::thread(&AsyncUploader::Run, this);
+}
+
+AsyncUploader::~AsyncUploader()
+{
+    Finish();
+    if (m_Thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_Wake.notify_one();
+        m_Thread.join();
+    }
+}
+
+void AsyncUploader::Run()
+{
+    bool current = m_Context->MakeCurrent();
+    if (!current)
+    {
+        // Jobs are still drained so Finish cannot hang; they all fail.
+        std::cerr << "AsyncUploader: failed to make the shared context current" << std::endl;
+    }
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;)
+    {
+        m_Wake.wait(lock, [this] { return m_Stop || !m_Jobs.empty(); });
+        if (m_Jobs.empty())
+            break;
+        Job job = std::move(m_Jobs.front());
+        m_Jobs.pop_front();
+        m_Busy = true;
+
+        lock.unlock();
+        Completed completed = current ? Execute(job, true) : Completed{nullptr, 0, false, std::move(job.onComplete)};
+        lock.lock();
+
+        m_Completed.push_back(std::move(completed));
+        m_Busy = false;
+        m_Idle.notify_all();
+    }
+    lock.unlock();
+    if (current)
+        m_Context->DoneCurrent();
+}
+
+AsyncUploader::Completed AsyncUploader::Execute(Job& job, bool onWorker)
+{
+    Completed completed = {nullptr, job.buffer, job.buffer != 0, std::move(job.onComplete)};
+
+    // The worker context has bindings of its own, so it binds directly;
+    // the synchronous path runs on the render context and uses the cache.
+    auto bind = [onWorker](unsigned int buffer) {
+        if (onWorker)
+            GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+        else
+            GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    };
+
+    if (job.buffer == 0)
+    {
+        GLCall(glGenBuffers(1, &completed.buffer));
+        bind(completed.buffer);
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)job.data.size(), job.data.data(), job.usage));
+    }
+    else
+    {
+        bind(job.buffer);
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, job.offset, (GLsizeiptr)job.data.size(), job.data.data()));
+    }
+
+    if (onWorker)
+    {
+        bind(0);
+        GLCall(completed.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        // Another context only sees the fence once it has been flushed.
+        GLCall(glFlush());
+    }
+    return completed;
+}
+
+void AsyncUploader::Submit(Job job)
+{
+    m_Pending++;
+    m_UploadedBytes += job.data.size();
+    if (!m_Context)
+    {
+        m_Completed.push_back(Execute(job, false));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Jobs.push_back(std::move(job));
+    }
+    m_Wake.notify_one();
+}
+
+void AsyncUploader::Upload(std::vector<unsigned char> data, Callback onComplete, unsigned int usage)
+{
+    Submit({0, 0, usage, std::move(data), std::move(onComplete)});
+}
+
+void AsyncUploader::Update(unsigned int buffer, unsigned int offset, std::vector<unsigned char> data, Callback onComplete)
+{
+    Submit({buffer, offset, 0, std::move(data), std::move(onComplete)});
+}
+
+void AsyncUploader::Complete(Completed& completed)
+{
+    if (completed.fence)
+        GLCall(glDeleteSync(completed.fence));
+    if (completed.update)
+        GLStateCache::Get().ForgetBuffer(completed.buffer);
+    m_Pending--;
+    if (completed.onComplete)
+        completed.onComplete(completed.buffer);
+}
+
+void AsyncUploader::Poll()
+{
+    std::vector<Completed> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (size_t i = 0; i < m_Completed.size();)
+        {
+            Completed& completed = m_Completed[i];
+            bool signaled = true;
+            if (completed.fence)
+            {
+                GLenum result;
+                GLCall(result = glClientWaitSync(completed.fence, 0, 0));
+                signaled = result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+            }
+            if (!signaled)
+            {
+                i++;
+                continue;
+            }
+            ready.push_back(std::move(completed));
+            m_Completed.erase(m_Completed.begin() + i);
+        }
+    }
+    // Callbacks may submit new jobs, so run them without the lock.
+    for (Completed& completed : ready)
+        Complete(completed);
+}
+
+void AsyncUploader::Finish()
+{
+    std::vector<Completed> ready;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Idle.wait(lock, [this] { return m_Jobs.empty() && !m_Busy; });
+        ready.swap(m_Completed);
+    }
+    for (Completed& completed : ready)
+    {
+        if (completed.fence)
+            GLCall(glClientWaitSync(completed.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED));
+        Complete(completed);
+    }
+    // Callbacks may have queued more work.
+    if (m_Pending)
+        Finish();
+}
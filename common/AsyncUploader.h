@@ -0,0 +1,91 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "GLContext.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Uploads buffer data on a worker thread that owns a GLSharedContext, so the
+// render thread keeps drawing while large meshes stream in.
+//
+// Jobs are queued from the render thread. The worker uploads, fences and
+// flushes each one; Poll, called once per frame on the render thread, runs
+// the callback of every job whose fence has signaled. Only then may the
+// buffer (or updated range) be drawn from. If no shared context can be
+// created the uploads run synchronously inside Upload/Update instead and
+// the callbacks still arrive through Poll.
+//
+//     unsigned int size = (unsigned int)vertices.size();
+//     uploader.Upload(std::move(vertices), [&, size](unsigned int buffer) {
+//         meshes.push_back(VertexBuffer::Adopt(buffer, size));
+//     });
+class AsyncUploader
+{
+    public:
+        using Callback = std::function<void(unsigned int buffer)>;
+
+    private:
+        struct Job
+        {
+            unsigned int buffer;   // 0 creates a new buffer
+            unsigned int offset;
+            unsigned int usage;
+            std::vector<unsigned char> data;
+            Callback onComplete;
+        };
+
+        struct Completed
+        {
+            GLsync fence;
+            unsigned int buffer;
+            bool update;
+            Callback onComplete;
+        };
+
+        std::unique_ptr<GLSharedContext> m_Context;
+        std::thread m_Thread;
+        std::mutex m_Mutex;
+        std::condition_variable m_Wake;
+        std::condition_variable m_Idle;
+        std::deque<Job> m_Jobs;
+        std::vector<Completed> m_Completed;
+        bool m_Busy;
+        bool m_Stop;
+        unsigned int m_Pending;
+        unsigned long long m_UploadedBytes;
+
+        void Run();
+        Completed Execute(Job& job, bool onWorker);
+        void Submit(Job job);
+        void Complete(Completed& completed);
+
+    public:
+        // Call on the thread that owns context, after context.LoadGL().
+        explicit AsyncUploader(GLContext& context);
+        ~AsyncUploader();
+
+        AsyncUploader(const AsyncUploader&) = delete;
+        AsyncUploader& operator=(const AsyncUploader&) = delete;
+
+        // Creates a buffer holding data; onComplete receives its name (0 if
+        // the upload failed) and takes ownership of it.
+        void Upload(std::vector<unsigned char> data, Callback onComplete, unsigned int usage = GL_STATIC_DRAW);
+        // Writes data at offset into an existing buffer. Don't draw from that
+        // range until onComplete ran.
+        void Update(unsigned int buffer, unsigned int offset, std::vector<unsigned char> data, Callback onComplete = nullptr);
+
+        // Runs the callbacks of finished jobs; never blocks.
+        void Poll();
+        // Blocks until every job submitted so far has finished and its
+        // callback has run.
+        void Finish();
+
+        inline bool IsAsync() const { return m_Context != nullptr; }
+        inline unsigned int GetPendingCount() const { return m_Pending; }
+        inline unsigned long long GetUploadedBytes() const { return m_UploadedBytes; }
+};
@@ -0,0 +1,158 @@
+#include "CommandList.h"
+#include "GLDebug.h"
+#include "GLStateCache.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    class Reader
+    {
+        private:
+            const uint8_t* m_Data;
+
+        public:
+            explicit Reader(const uint8_t* data) : m_Data(data) {}
+
+            template<typename T>
+            T Read()
+            {
+                T value;
+                std::memcpy(&value, m_Data, sizeof(T));
+                m_Data += sizeof(T);
+                return value;
+            }
+
+            const float* Floats(size_t count, float* out)
+            {
+                std::memcpy(out, m_Data, count * sizeof(float));
+                m_Data += count * sizeof(float);
+                return out;
+            }
+
+            inline const uint8_t* Get() const { return m_Data; }
+    };
+}
+
+void CommandList::Execute() const
+{
+    GLStateCache& state = GLStateCache::Get();
+    Reader in(m_Data.data());
+    const uint8_t* end = m_Data.data() + m_Data.size();
+    while (in.Get() < end)
+    {
+        switch (in.Read<Op>())
+        {
+            case Op::UseProgram:
+                state.UseProgram(in.Read<unsigned int>());
+                break;
+            case Op::BindVertexArray:
+                state.BindVertexArray(in.Read<unsigned int>());
+                break;
+            case Op::BindElementBuffer:
+                state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, in.Read<unsigned int>());
+                break;
+            case Op::BindTexture:
+            {
+                unsigned int unit = in.Read<uint8_t>();
+                state.BindTexture(unit, GL_TEXTURE_2D, in.Read<unsigned int>());
+                break;
+            }
+            case Op::Uniform1i:
+            {
+                int location = in.Read<int>();
+                GLCall(glUniform1i(location, in.Read<int>()));
+                break;
+            }
+            case Op::Uniform1f:
+            {
+                int location = in.Read<int>();
+                GLCall(glUniform1f(location, in.Read<float>()));
+                break;
+            }
+            case Op::Uniform4f:
+            {
+                int location = in.Read<int>();
+                float v[4];
+                in.Floats(4, v);
+                GLCall(glUniform4f(location, v[0], v[1], v[2], v[3]));
+                break;
+            }
+            case Op::UniformMatrix4f:
+            {
+                int location = in.Read<int>();
+                float m[16];
+                GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, in.Floats(16, m)));
+                break;
+            }
+            case Op::DrawElements:
+            {
+                unsigned int count = in.Read<unsigned int>();
+                unsigned int type = in.Read<uint16_t>();
+                const void* offset = (const void*)(size_t)in.Read<unsigned int>();
+                int baseVertex = in.Read<int>();
+                unsigned int instanceCount = in.Read<unsigned int>();
+                if (baseVertex == 0 && instanceCount == 1)
+                    GLCall(glDrawElements(GL_TRIANGLES, count, type, offset));
+                else if (instanceCount == 1)
+                    GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, count, type, offset, baseVertex));
+                else
+                    GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, type, offset, instanceCount, baseVertex));
+                break;
+            }
+            case Op::DrawArrays:
+            {
+                unsigned int first = in.Read<unsigned int>();
+                GLCall(glDrawArrays(GL_TRIANGLES, first, in.Read<unsigned int>()));
+                break;
+            }
+        }
+    }
+}
+
+void ParallelCommandRecorder::Record(size_t count, size_t grain, const RecordFunction& record)
+{
+    auto start = Clock::now();
+    grain = grain ? grain : 1;
+    m_ListCount = (unsigned int)((count + grain - 1) / grain);
+    if (m_Lists.size() < m_ListCount)
+        m_Lists.resize(m_ListCount);
+
+    // One pool chunk per list, so a list is only ever touched by one thread.
+    WorkerPool::Get().ParallelFor(m_ListCount, 1, [&](size_t first, size_t last) {
+        for (size_t index = first; index < last; index++)
+        {
+            CommandList& list = m_Lists[index];
+            list.Clear();
+            size_t begin = index * grain;
+            record(list, begin, std::min(begin + grain, count));
+        }
+    });
+
+    m_Stats = Stats();
+    m_Stats.lists = m_ListCount;
+    for (unsigned int i = 0; i < m_ListCount; i++)
+    {
+        m_Stats.commands += m_Lists[i].GetCommandCount();
+        m_Stats.bytes += m_Lists[i].GetSize();
+    }
+    m_Stats.recordMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void ParallelCommandRecorder::Execute()
+{
+    auto start = Clock::now();
+    for (unsigned int i = 0; i < m_ListCount; i++)
+        m_Lists[i].Execute();
+    m_Stats.executeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void ParallelCommandRecorder::Report(std::ostream& out) const
+{
+    out << "Command lists: " << m_Stats.commands << " commands (" << m_Stats.bytes / 1024 << " KiB) in "
+        << m_Stats.lists << " lists, record " << m_Stats.recordMs << " ms on " << WorkerPool::Get().GetThreadCount()
+        << " threads, execute " << m_Stats.executeMs << " ms" << std::endl;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+// Compact binary recording of binds, uniforms and draws.
+//
+// Recording makes no GL calls, so any thread can fill a list; Execute
+// replays it on the context thread, binding through the GLStateCache. Each
+// record is a one-byte opcode followed by its arguments, packed unaligned.
+// Names are raw GL names.
+class CommandList
+{
+    public:
+        enum class Op : uint8_t
+        {
+            UseProgram, BindVertexArray, BindElementBuffer, BindTexture,
+            Uniform1i, Uniform1f, Uniform4f, UniformMatrix4f,
+            DrawElements, DrawArrays
+        };
+
+    private:
+        std::vector<uint8_t> m_Data;
+        unsigned int m_CommandCount;
+
+        template<typename T>
+        void Write(const T& value)
+        {
+            size_t size = m_Data.size();
+            m_Data.resize(size + sizeof(T));
+            std::memcpy(m_Data.data() + size, &value, sizeof(T));
+        }
+
+        void Begin(Op op)
+        {
+            Write(op);
+            m_CommandCount++;
+        }
+
+    public:
+        CommandList() : m_CommandCount(0) {}
+
+        // Keeps the allocation for the next frame.
+        void Clear()
+        {
+            m_Data.clear();
+            m_CommandCount = 0;
+        }
+
+        void UseProgram(unsigned int program) { Begin(Op::UseProgram); Write(program); }
+        void BindVertexArray(unsigned int vertexArray) { Begin(Op::BindVertexArray); Write(vertexArray); }
+        void BindElementBuffer(unsigned int buffer) { Begin(Op::BindElementBuffer); Write(buffer); }
+        // GL_TEXTURE_2D on unit.
+        void BindTexture(unsigned int unit, unsigned int texture) { Begin(Op::BindTexture); Write((uint8_t)unit); Write(texture); }
+
+        void Uniform1i(int location, int value) { Begin(Op::Uniform1i); Write(location); Write(value); }
+        void Uniform1f(int location, float value) { Begin(Op::Uniform1f); Write(location); Write(value); }
+        void Uniform4f(int location, float x, float y, float z, float w)
+        {
+            Begin(Op::Uniform4f);
+            Write(location);
+            const float values[4] = {x, y, z, w};
+            Write(values);
+        }
+        // Column major.
+        void UniformMatrix4f(int location, const float* values)
+        {
+            Begin(Op::UniformMatrix4f);
+            Write(location);
+            size_t size = m_Data.size();
+            m_Data.resize(size + 16 * sizeof(float));
+            std::memcpy(m_Data.data() + size, values, 16 * sizeof(float));
+        }
+
+        // Triangles; offset is in bytes into the element buffer.
+        void DrawElements(unsigned int count, unsigned int type, unsigned int offset, int baseVertex = 0,
+                          unsigned int instanceCount = 1)
+        {
+            Begin(Op::DrawElements);
+            Write(count);
+            Write((uint16_t)type);
+            Write(offset);
+            Write(baseVertex);
+            Write(instanceCount);
+        }
+        void DrawArrays(unsigned int first, unsigned int count)
+        {
+            Begin(Op::DrawArrays);
+            Write(first);
+            Write(count);
+        }
+
+        // Replays every command; call on the context thread.
+        void Execute() const;
+
+        inline unsigned int GetCommandCount() const { return m_CommandCount; }
+        inline size_t GetSize() const { return m_Data.size(); }
+};
+
+// Records a frame's commands on the WorkerPool and replays them on the
+// context thread.
+//
+// The work is cut into fixed chunks of grain items, and every chunk records
+// into its own list whatever thread picks it up; Execute replays the lists
+// in chunk order, so the command stream is the same as a serial recording
+// regardless of scheduling.
+//
+//     recorder.Record(objects.size(), 256, [&](CommandList& list, size_t begin, size_t end) {
+//         for (size_t i = begin; i < end; i++) ... list.DrawElements(...);
+//     });
+//     recorder.Execute();
+class ParallelCommandRecorder
+{
+    public:
+        using RecordFunction = std::function<void(CommandList& list, size_t begin, size_t end)>;
+
+        struct Stats
+        {
+            unsigned int lists = 0;
+            unsigned long long commands = 0;
+            unsigned long long bytes = 0;
+            double recordMs = 0.0;
+            double executeMs = 0.0;
+        };
+
+    private:
+        std::vector<CommandList> m_Lists;
+        unsigned int m_ListCount;
+        Stats m_Stats;
+
+    public:
+        ParallelCommandRecorder() : m_ListCount(0) {}
+
+        // Clears the previous recording. Runs record on the WorkerPool and the
+        // calling thread; it must not make GL calls.
+        void Record(size_t count, size_t grain, const RecordFunction& record);
+        void Execute();
+
+        inline unsigned int GetListCount() const { return m_ListCount; }
+        inline const CommandList& GetList(unsigned int index) const { return m_Lists[index]; }
+        // Of the last Record/Execute.
+        inline const Stats& GetStats() const { return m_Stats; }
+        void Report(std::ostream& out) const;
+};
@@ -0,0 +1,153 @@
+#include "FrameBenchmark.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    struct Summary
+    {
+        double min, mean, p50, p95, p99, max;
+    };
+
+    Summary Summarize(std::vector<double> values)
+    {
+        Summary summary = {};
+        if (values.empty())
+            return summary;
+        std::sort(values.begin(), values.end());
+        auto at = [&](double quantile) {
+            return values[std::min(values.size() - 1, (size_t)(quantile * (values.size() - 1) + 0.5))];
+        };
+        double total = 0.0;
+        for (double value : values)
+            total += value;
+        summary.min = values.front();
+        summary.mean = total / values.size();
+        summary.p50 = at(0.50);
+        summary.p95 = at(0.95);
+        summary.p99 = at(0.99);
+        summary.max = values.back();
+        return summary;
+    }
+
+    void PrintSeries(std::ostream& out, const char* label, const std::vector<double>& values)
+    {
+        out << std::setw(8) << label;
+        if (values.empty())
+        {
+            out << "  n/a\n";
+            return;
+        }
+        Summary s = Summarize(values);
+        out << std::setw(10) << s.min << std::setw(10) << s.mean << std::setw(10) << s.p50
+            << std::setw(10) << s.p95 << std::setw(10) << s.p99 << std::setw(10) << s.max << "\n";
+    }
+
+    void WriteSeries(std::ostream& out, const char* key, const std::vector<double>& values, bool last)
+    {
+        out << "  \"" << key << "\": ";
+        if (values.empty())
+            out << "null";
+        else
+        {
+            Summary s = Summarize(values);
+            out << "{\"min\": " << s.min << ", \"mean\": " << s.mean << ", \"p50\": " << s.p50
+                << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}";
+        }
+        out << (last ? "\n" : ",\n");
+    }
+}
+
+FrameBenchmarkDesc FrameBenchmarkDesc::FromArgs(int argc, char** argv, const char* name)
+{
+    FrameBenchmarkDesc desc;
+    desc.name = name;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0)
+            desc.frames = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--warmup") == 0)
+            desc.warmupFrames = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--json") == 0)
+            desc.jsonPath = argv[++i];
+    }
+    return desc;
+}
+
+FrameBenchmark::FrameBenchmark(const FrameBenchmarkDesc& desc)
+    : m_Desc(desc), m_Frame(0)
+{
+    m_CpuMs.reserve(desc.frames);
+    m_SwapMs.reserve(desc.frames);
+    m_FrameMs.reserve(desc.frames);
+    m_GpuMs.reserve(desc.frames);
+}
+
+void FrameBenchmark::BeginFrame()
+{
+    m_FrameStart = Clock::now();
+}
+
+void FrameBenchmark::BeginSwap()
+{
+    m_SwapStart = Clock::now();
+}
+
+void FrameBenchmark::EndFrame(double gpuMs)
+{
+    auto end = Clock::now();
+    if (!IsWarmingUp())
+    {
+        m_CpuMs.push_back(std::chrono::duration<double, std::milli>(m_SwapStart - m_FrameStart).count());
+        m_SwapMs.push_back(std::chrono::duration<double, std::milli>(end - m_SwapStart).count());
+        m_FrameMs.push_back(std::chrono::duration<double, std::milli>(end - m_FrameStart).count());
+        if (gpuMs >= 0.0)
+            m_GpuMs.push_back(gpuMs);
+    }
+    m_Frame++;
+}
+
+void FrameBenchmark::Report(std::ostream& out) const
+{
+    out << m_Desc.name << ": " << m_FrameMs.size() << " frames after " << m_Desc.warmupFrames << " warmup (ms)\n";
+    out << std::setw(8) << "" << std::setw(10) << "min" << std::setw(10) << "mean" << std::setw(10) << "p50"
+        << std::setw(10) << "p95" << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+    PrintSeries(out, "frame", m_FrameMs);
+    PrintSeries(out, "cpu", m_CpuMs);
+    PrintSeries(out, "swap", m_SwapMs);
+    PrintSeries(out, "gpu", m_GpuMs);
+    out.flush();
+}
+
+void FrameBenchmark::WriteJson(std::ostream& out) const
+{
+    out << "{\n";
+    out << "  \"name\": \"" << m_Desc.name << "\",\n";
+    out << "  \"frames\": " << m_FrameMs.size() << ",\n";
+    out << "  \"warmup\": " << m_Desc.warmupFrames << ",\n";
+    WriteSeries(out, "frame_ms", m_FrameMs, false);
+    WriteSeries(out, "cpu_ms", m_CpuMs, false);
+    WriteSeries(out, "swap_ms", m_SwapMs, false);
+    WriteSeries(out, "gpu_ms", m_GpuMs, true);
+    out << "}\n";
+}
+
+bool FrameBenchmark::Finish(std::ostream& report) const
+{
+    Report(report);
+    if (m_Desc.jsonPath.empty())
+        return true;
+
+    std::ofstream file(m_Desc.jsonPath);
+    if (!file)
+    {
+        std::cerr << "Failed to write benchmark results to " << m_Desc.jsonPath << std::endl;
+        return false;
+    }
+    WriteJson(file);
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct FrameBenchmarkDesc
+{
+    std::string name;
+    // Measured frames; 0 disables the benchmark.
+    unsigned int frames = 0;
+    unsigned int warmupFrames = 0;
+    std::string jsonPath;
+
+    // Reads --frames N, --warmup M and --json path.
+    static FrameBenchmarkDesc FromArgs(int argc, char** argv, const char* name);
+};
+
+// Fixed-frame benchmark: per-frame CPU time (start of frame to swap),
+// swap time and, when the caller has it, GPU time. Warmup frames are run
+// but not recorded. Pair with --no-vsync so swaps do not wait for vblank.
+//
+//     benchmark.BeginFrame();
+//     ... render ...
+//     benchmark.BeginSwap();
+//     context->SwapBuffers();
+//     benchmark.EndFrame(profiler.GetLastFrameGpuMs());
+class FrameBenchmark
+{
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        FrameBenchmarkDesc m_Desc;
+        unsigned int m_Frame;
+        Clock::time_point m_FrameStart;
+        Clock::time_point m_SwapStart;
+        std::vector<double> m_CpuMs;
+        std::vector<double> m_SwapMs;
+        std::vector<double> m_FrameMs;
+        std::vector<double> m_GpuMs;
+
+    public:
+        explicit FrameBenchmark(const FrameBenchmarkDesc& desc);
+
+        inline bool IsEnabled() const { return m_Desc.frames > 0; }
+        inline bool IsWarmingUp() const { return m_Frame < m_Desc.warmupFrames; }
+        // Frames the render loop has to run, warmup included.
+        inline unsigned int GetTotalFrames() const { return m_Desc.frames + m_Desc.warmupFrames; }
+
+        void BeginFrame();
+        void BeginSwap();
+        // gpuMs < 0 means no GPU time for this frame.
+        void EndFrame(double gpuMs = -1.0);
+
+        // min/mean/p50/p95/p99/max of every recorded series.
+        void Report(std::ostream& out) const;
+        void WriteJson(std::ostream& out) const;
+        // Writes JSON to desc.jsonPath if one was given.
+        bool Finish(std::ostream& report) const;
+};
@@ -0,0 +1,124 @@
+#include "FramePipeline.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+    double Milliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+FrameMailbox::FrameMailbox(unsigned int slotCount)
+    : m_Slots(std::max(slotCount, 2u)), m_Closed(false), m_Started(false)
+{
+    for (unsigned int slot = 0; slot < m_Slots.size(); slot++)
+        m_Free.push_back(slot);
+}
+
+int FrameMailbox::BeginWrite()
+{
+    auto start = Clock::now();
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Changed.wait(lock, [&] { return m_Closed || !m_Free.empty(); });
+    if (m_Closed)
+        return -1;
+
+    unsigned int slot = m_Free.front();
+    m_Free.pop_front();
+    auto now = Clock::now();
+    if (!m_Started)
+    {
+        m_Started = true;
+        m_Start = now;
+    }
+    else
+        m_Stats.produceWaitMs += Milliseconds(now - start);
+    m_Slots[slot].produceStart = now;
+    return (int)slot;
+}
+
+void FrameMailbox::EndWrite(unsigned int slot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        double ms = Milliseconds(Clock::now() - m_Slots[slot].produceStart);
+        m_Stats.produceMs += ms;
+        m_Stats.produceMaxMs = std::max(m_Stats.produceMaxMs, ms);
+        m_Published.push_back(slot);
+    }
+    m_Changed.notify_all();
+}
+
+int FrameMailbox::BeginRead()
+{
+    auto start = Clock::now();
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Changed.wait(lock, [&] { return m_Closed || !m_Published.empty(); });
+    if (m_Published.empty())
+        return -1;
+
+    unsigned int slot = m_Published.front();
+    m_Published.pop_front();
+    auto now = Clock::now();
+    m_Stats.consumeWaitMs += Milliseconds(now - start);
+    m_Slots[slot].consumeStart = now;
+    return (int)slot;
+}
+
+void FrameMailbox::EndRead(unsigned int slot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto now = Clock::now();
+        const Slot& timing = m_Slots[slot];
+        double consume = Milliseconds(now - timing.consumeStart);
+        double latency = Milliseconds(now - timing.produceStart);
+        m_Stats.frames++;
+        m_Stats.consumeMs += consume;
+        m_Stats.consumeMaxMs = std::max(m_Stats.consumeMaxMs, consume);
+        m_Stats.latencyMs += latency;
+        m_Stats.latencyMaxMs = std::max(m_Stats.latencyMaxMs, latency);
+        m_Stats.elapsedMs = Milliseconds(now - m_Start);
+        m_Free.push_back(slot);
+    }
+    m_Changed.notify_all();
+}
+
+void FrameMailbox::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Closed = true;
+    }
+    m_Changed.notify_all();
+}
+
+FrameMailbox::Stats FrameMailbox::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void FrameMailbox::Report(std::ostream& out, const char* producer, const char* consumer)
+{
+    Stats stats = GetStats();
+    if (stats.frames == 0)
+    {
+        out << "FramePipeline: no frames" << std::endl;
+        return;
+    }
+    double frames = (double)stats.frames;
+    auto stage = [&](const char* name, double ms, double maxMs, double waitMs) {
+        out << "  " << std::left << std::setw(10) << name << std::right << " : " << ms / frames << " ms avg, "
+            << maxMs << " ms max, " << waitMs / frames << " ms waiting, "
+            << (ms > 0.0 ? 1000.0 * frames / ms : 0.0) << " frames/s if alone\n";
+    };
+    out << "FramePipeline: " << stats.frames << " frames through " << m_Slots.size() << " slots, "
+        << std::fixed << std::setprecision(3) << 1000.0 * frames / stats.elapsedMs << " frames/s\n";
+    stage(producer, stats.produceMs, stats.produceMaxMs, stats.produceWaitMs);
+    stage(consumer, stats.consumeMs, stats.consumeMaxMs, stats.consumeWaitMs);
+    out << "  latency    : " << stats.latencyMs / frames << " ms avg, " << stats.latencyMaxMs
+        << " ms max from simulation start to submitted" << std::endl;
+}
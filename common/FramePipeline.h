@@ -0,0 +1,168 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Slot bookkeeping between one producer and one consumer thread.
+//
+// The producer takes a free slot, fills it and publishes it; the consumer
+// takes published slots oldest first and frees them when done. Every
+// published slot is consumed, so no frame is skipped, and with n slots the
+// producer runs at most n - 1 frames ahead. Times every stage.
+class FrameMailbox
+{
+    public:
+        struct Stats
+        {
+            unsigned long long frames = 0;
+            // Producer: filling slots, and waiting for a free one.
+            double produceMs = 0.0;
+            double produceMaxMs = 0.0;
+            double produceWaitMs = 0.0;
+            // Consumer: holding slots, and waiting for a published one.
+            double consumeMs = 0.0;
+            double consumeMaxMs = 0.0;
+            double consumeWaitMs = 0.0;
+            // Start of filling to end of consuming.
+            double latencyMs = 0.0;
+            double latencyMaxMs = 0.0;
+            // First BeginWrite to last EndRead.
+            double elapsedMs = 0.0;
+        };
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Slot
+        {
+            Clock::time_point produceStart;
+            Clock::time_point consumeStart;
+        };
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Changed;
+        std::vector<Slot> m_Slots;
+        std::deque<unsigned int> m_Free;
+        std::deque<unsigned int> m_Published;
+        bool m_Closed;
+        bool m_Started;
+        Clock::time_point m_Start;
+        Stats m_Stats;
+
+    public:
+        // slotCount is clamped to at least 2.
+        explicit FrameMailbox(unsigned int slotCount);
+
+        FrameMailbox(const FrameMailbox&) = delete;
+        FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+        // Block until a slot is available; -1 once closed (BeginRead: and
+        // nothing is left to consume).
+        int BeginWrite();
+        void EndWrite(unsigned int slot);
+        int BeginRead();
+        void EndRead(unsigned int slot);
+
+        // Wakes and fails every blocked and later BeginWrite. Published slots
+        // can still be read.
+        void Close();
+
+        inline unsigned int GetSlotCount() const { return (unsigned int)m_Slots.size(); }
+        Stats GetStats();
+        void Report(std::ostream& out, const char* producer, const char* consumer);
+};
+
+// Runs a simulation on its own thread, one frame ahead of rendering.
+//
+// simulate(packet, frame) fills a packet with everything a frame needs:
+// transforms, uniform values, the visible draws. It runs on the simulation
+// thread and must not make GL calls. The render thread acquires packets in
+// frame order and submits them while the next frame is simulated. A packet
+// is read-only once published and is reused after Release, so simulate
+// overwrites the whole packet; keeping its vectors' capacity avoids
+// allocating per frame. slotCount 2 is double buffering; 3 lets simulation
+// absorb a slow render frame.
+//
+//     FramePipeline<Packet> pipeline([&](Packet& packet, unsigned long long frame) { ... });
+//     while (running)
+//     {
+//         const Packet* packet = pipeline.Acquire();
+//         ... submit *packet ...
+//         pipeline.Release();
+//     }
+template<typename Packet>
+class FramePipeline
+{
+    public:
+        using SimulateFunction = std::function<void(Packet& packet, unsigned long long frame)>;
+
+    private:
+        std::vector<Packet> m_Packets;
+        FrameMailbox m_Mailbox;
+        SimulateFunction m_Simulate;
+        int m_Acquired;
+        std::thread m_Thread;
+
+        void Run()
+        {
+            for (unsigned long long frame = 0;; frame++)
+            {
+                int slot = m_Mailbox.BeginWrite();
+                if (slot < 0)
+                    return;
+                m_Simulate(m_Packets[slot], frame);
+                m_Mailbox.EndWrite((unsigned int)slot);
+            }
+        }
+
+    public:
+        explicit FramePipeline(SimulateFunction simulate, unsigned int slotCount = 2)
+            : m_Packets(slotCount < 2 ? 2 : slotCount), m_Mailbox(slotCount), m_Simulate(std::move(simulate)),
+              m_Acquired(-1), m_Thread(&FramePipeline::Run, this)
+        {
+        }
+
+        ~FramePipeline() { Stop(); }
+
+        FramePipeline(const FramePipeline&) = delete;
+        FramePipeline& operator=(const FramePipeline&) = delete;
+
+        // The next frame's packet, waiting for the simulation if needed;
+        // nullptr after Stop.
+        const Packet* Acquire()
+        {
+            if (!m_Thread.joinable())
+                return nullptr;
+            if (m_Acquired < 0)
+                m_Acquired = m_Mailbox.BeginRead();
+            return m_Acquired < 0 ? nullptr : &m_Packets[m_Acquired];
+        }
+
+        // Hands the packet back to the simulation; call after submitting it.
+        void Release()
+        {
+            if (m_Acquired < 0)
+                return;
+            m_Mailbox.EndRead((unsigned int)m_Acquired);
+            m_Acquired = -1;
+        }
+
+        // Ends the simulation thread; packets simulated ahead are dropped.
+        // Render thread only.
+        void Stop()
+        {
+            Release();
+            m_Mailbox.Close();
+            if (m_Thread.joinable())
+                m_Thread.join();
+        }
+
+        inline FrameMailbox::Stats GetStats() { return m_Mailbox.GetStats(); }
+        void Report(std::ostream& out) { m_Mailbox.Report(out, "simulate", "render"); }
+};
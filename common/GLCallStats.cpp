@@ -0,0 +1,146 @@
+#include "GLCallStats.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    std::atomic<GLCallSiteStats*> s_Head{nullptr};
+
+    // Prints the table on exit and writes JSON to $GL_CALL_STATS_JSON if set.
+    void DumpAtExit()
+    {
+        GLCallStatsDump(std::cout);
+        if (const char* path = std::getenv("GL_CALL_STATS_JSON"))
+        {
+            std::ofstream file(path);
+            GLCallStatsDumpJson(file);
+        }
+    }
+
+    std::vector<const GLCallSiteStats*> SortedSites()
+    {
+        std::vector<const GLCallSiteStats*> sites;
+        for (const GLCallSiteStats* site = GLCallStatsFirst(); site; site = site->next)
+            if (site->count.load(std::memory_order_relaxed))
+                sites.push_back(site);
+        std::sort(sites.begin(), sites.end(), [](const GLCallSiteStats* a, const GLCallSiteStats* b) {
+            return a->totalNs.load(std::memory_order_relaxed) > b->totalNs.load(std::memory_order_relaxed);
+        });
+        return sites;
+    }
+
+    void WriteJsonString(std::ostream& out, const char* text)
+    {
+        out << '"';
+        for (; *text; ++text)
+        {
+            if (*text == '"' || *text == '\\')
+                out << '\\';
+            out << (*text == '\n' ? ' ' : *text);
+        }
+        out << '"';
+    }
+}
+
+GLCallSiteStats::GLCallSiteStats(const char* function, const char* file, int line)
+    : function(function), file(file), line(line)
+{
+    for (auto& bucket : buckets)
+        bucket.store(0, std::memory_order_relaxed);
+
+    next = s_Head.load(std::memory_order_relaxed);
+    while (!s_Head.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed));
+
+    static bool registered = (std::atexit(DumpAtExit), true);
+    (void)registered;
+}
+
+uint64_t GLCallSiteStats::Percentile(double quantile) const
+{
+    uint64_t total = count.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+    uint64_t target = (uint64_t)(quantile * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target)
+            return BucketLowerBound(i);
+    }
+    return maxNs.load(std::memory_order_relaxed);
+}
+
+GLCallSiteStats* GLCallStatsFirst()
+{
+    return s_Head.load(std::memory_order_acquire);
+}
+
+void GLCallStatsDump(std::ostream& out)
+{
+    out << "GLCall sites by total CPU time (ns)\n";
+    out << std::setw(10) << "count" << std::setw(14) << "total" << std::setw(10) << "mean"
+        << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+        << std::setw(12) << "max" << "  site\n";
+    for (const GLCallSiteStats* site : SortedSites())
+    {
+        uint64_t count = site->count.load(std::memory_order_relaxed);
+        uint64_t total = site->totalNs.load(std::memory_order_relaxed);
+        out << std::setw(10) << count << std::setw(14) << total << std::setw(10) << total / count
+            << std::setw(10) << site->Percentile(0.50) << std::setw(10) << site->Percentile(0.90)
+            << std::setw(10) << site->Percentile(0.99) << std::setw(12) << site->maxNs.load(std::memory_order_relaxed)
+            << "  " << site->file << ":" << site->line << " " << site->function << "\n";
+    }
+    out.flush();
+}
+
+void GLCallStatsDumpJson(std::ostream& out)
+{
+    out << "{\n  \"sites\": [";
+    bool first = true;
+    for (const GLCallSiteStats* site : SortedSites())
+    {
+        uint64_t count = site->count.load(std::memory_order_relaxed);
+        out << (first ? "\n" : ",\n") << "    {\"function\": ";
+        WriteJsonString(out, site->function);
+        out << ", \"file\": ";
+        WriteJsonString(out, site->file);
+        out << ", \"line\": " << site->line
+            << ", \"count\": " << count
+            << ", \"total_ns\": " << site->totalNs.load(std::memory_order_relaxed)
+            << ", \"p50_ns\": " << site->Percentile(0.50)
+            << ", \"p90_ns\": " << site->Percentile(0.90)
+            << ", \"p99_ns\": " << site->Percentile(0.99)
+            << ", \"max_ns\": " << site->maxNs.load(std::memory_order_relaxed)
+            << ", \"histogram\": [";
+        bool firstBucket = true;
+        for (int i = 0; i < GLCallSiteStats::BUCKET_COUNT; i++)
+        {
+            uint64_t n = site->buckets[i].load(std::memory_order_relaxed);
+            if (!n)
+                continue;
+            out << (firstBucket ? "" : ", ") << "[" << GLCallSiteStats::BucketLowerBound(i) << ", " << n << "]";
+            firstBucket = false;
+        }
+        out << "]}";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+    out.flush();
+}
+
+void GLCallStatsReset()
+{
+    for (GLCallSiteStats* site = GLCallStatsFirst(); site; site = site->next)
+    {
+        site->count.store(0, std::memory_order_relaxed);
+        site->totalNs.store(0, std::memory_order_relaxed);
+        site->maxNs.store(0, std::memory_order_relaxed);
+        for (auto& bucket : site->buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+// Per-call-site timing for GLCall, enabled with -DGL_CALL_STATS=1.
+//
+// Every GLCall expansion owns one function-local static GLCallSiteStats,
+// registered on first use in a lock-free list. Recording is a handful of
+// relaxed atomic adds: call count, total time and one bucket of a
+// log-linear (HDR style, 8 sub-buckets per power of two, ~12% precision)
+// histogram of the CPU nanoseconds spent inside the wrapped call.
+class GLCallSiteStats
+{
+    public:
+        static constexpr int SUB_BUCKET_BITS = 3;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static constexpr int BUCKET_COUNT = 40 * SUB_BUCKETS;
+
+        const char* function;
+        const char* file;
+        int line;
+
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> totalNs{0};
+        std::atomic<uint64_t> maxNs{0};
+        std::atomic<uint64_t> buckets[BUCKET_COUNT];
+
+        GLCallSiteStats* next;
+
+        GLCallSiteStats(const char* function, const char* file, int line);
+
+        void Record(uint64_t ns)
+        {
+            count.fetch_add(1, std::memory_order_relaxed);
+            totalNs.fetch_add(ns, std::memory_order_relaxed);
+            buckets[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+            uint64_t previous = maxNs.load(std::memory_order_relaxed);
+            while (ns > previous && !maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed));
+        }
+
+        // Value at the given quantile (0..1), reported as the bucket's lower bound.
+        uint64_t Percentile(double quantile) const;
+
+        static int BucketIndex(uint64_t ns)
+        {
+            if (ns < SUB_BUCKETS)
+                return (int)ns;
+            int exponent = 63 - CountLeadingZeros(ns);
+            int sub = (int)(ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+            int index = (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+            return index < BUCKET_COUNT ? index : BUCKET_COUNT - 1;
+        }
+
+        static uint64_t BucketLowerBound(int index)
+        {
+            if (index < SUB_BUCKETS)
+                return (uint64_t)index;
+            int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+            uint64_t sub = (uint64_t)(index % SUB_BUCKETS);
+            return (SUB_BUCKETS + sub) << (exponent - SUB_BUCKET_BITS);
+        }
+
+    private:
+        static int CountLeadingZeros(uint64_t value)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanReverse64(&index, value);
+            return 63 - (int)index;
+#else
+            return __builtin_clzll(value);
+#endif
+        }
+};
+
+// Times the enclosing scope into a call site.
+class GLCallTimer
+{
+    private:
+        GLCallSiteStats& m_Site;
+        std::chrono::steady_clock::time_point m_Start;
+
+    public:
+        explicit GLCallTimer(GLCallSiteStats& site)
+            : m_Site(site), m_Start(std::chrono::steady_clock::now()) {}
+        ~GLCallTimer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - m_Start;
+            m_Site.Record((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+};
+
+// Head of the registered call-site list.
+GLCallSiteStats* GLCallStatsFirst();
+
+// Table of every site sorted by total time: count, total, mean, p50/p90/p99/max.
+void GLCallStatsDump(std::ostream& out);
+void GLCallStatsDumpJson(std::ostream& out);
+// Zeroes all counters, e.g. after warmup frames.
+void GLCallStatsReset();
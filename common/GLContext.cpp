@@ -0,0 +1,94 @@
+#include "GLContext.h"
+#include "GLDebug.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+std::unique_ptr<GLContext> CreateGlfwContext(const GLContextDesc& desc);
+std::unique_ptr<GLContext> CreateEglContext(const GLContextDesc& desc);
+
+namespace
+{
+    const GLContext* s_Loading = nullptr;
+}
+
+GLContextDesc GLContextDesc::FromArgs(int argc, char** argv, const GLContextDesc& defaults)
+{
+    GLContextDesc desc = defaults;
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--headless") == 0)
+            desc.headless = true;
+        else if (std::strcmp(arg, "--no-vsync") == 0)
+            desc.vsync = false;
+        else if (std::strcmp(arg, "--size") == 0 && hasValue)
+            std::sscanf(argv[++i], "%dx%d", &desc.width, &desc.height);
+        else if (std::strcmp(arg, "--frames") == 0 && hasValue)
+            desc.maxFrames = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(arg, "--capture") == 0 && hasValue)
+            desc.capturePath = argv[++i];
+    }
+    return desc;
+}
+
+std::unique_ptr<GLContext> GLContext::Create(const GLContextDesc& desc)
+{
+    if (desc.headless)
+        return CreateEglContext(desc);
+    return CreateGlfwContext(desc);
+}
+
+bool GLContext::LoadGL()
+{
+    s_Loading = this;
+    int loaded = gladLoadGLLoader([](const char* name) { return s_Loading->GetProcAddress(name); });
+    s_Loading = nullptr;
+    if (!loaded)
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    return OnLoaded();
+}
+
+bool GLContext::ShouldClose() const
+{
+    return m_Desc.maxFrames && m_FrameCount >= m_Desc.maxFrames;
+}
+
+void GLContext::SwapBuffers()
+{
+    m_FrameCount++;
+    if (!m_Desc.capturePath.empty() && m_FrameCount == m_Desc.maxFrames)
+        Capture(m_Desc.capturePath);
+    Present();
+}
+
+bool GLContext::Capture(const std::string& path) const
+{
+    GLint viewport[4];
+    GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+    int width = viewport[2];
+    int height = viewport[3];
+
+    std::vector<unsigned char> pixels((size_t)width * height * 3);
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+    GLCall(glReadPixels(viewport[0], viewport[1], width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data()));
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Failed to write capture " << path << std::endl;
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    // GL rows run bottom-up, PPM rows top-down.
+    for (int y = height - 1; y >= 0; y--)
+        file.write(reinterpret_cast<const char*>(&pixels[(size_t)y * width * 3]), (std::streamsize)width * 3);
+    return true;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+struct GLFWwindow;
+
+struct GLContextDesc
+{
+    int width = 800;
+    int height = 600;
+    const char* title = "learnopengl";
+    // Render into an offscreen framebuffer on an EGL display instead of a window.
+    bool headless = false;
+    bool visible = true;
+    bool vsync = true;
+    bool debug = false;
+    // Stop after this many frames; 0 runs until the window is closed.
+    unsigned int maxFrames = 0;
+    // Written as binary PPM on the last frame of a maxFrames run.
+    std::string capturePath;
+
+    // Returns defaults overridden by:
+    //   --headless  --no-vsync  --size WxH  --frames N  --capture file.ppm
+    // Unknown arguments are left for the caller.
+    static GLContextDesc FromArgs(int argc, char** argv, const GLContextDesc& defaults);
+};
+
+// A context that shares buffers, textures, programs and sync objects (but
+// not VAOs or FBOs) with the GLContext that created it. Create and destroy
+// it on that context's thread; make it current on exactly one other thread.
+class GLSharedContext
+{
+    public:
+        virtual ~GLSharedContext() = default;
+
+        // Call on the worker thread before its first GL call.
+        virtual bool MakeCurrent() = 0;
+        // Call on the worker thread before the context is destroyed.
+        virtual void DoneCurrent() = 0;
+};
+
+// Owns the GL context the samples render into. The window backend wraps
+// GLFW; the headless backend creates a surfaceless (or pbuffer) EGL context
+// and renders into an FBO of the requested size, so the same render loop
+// runs on machines without a display, e.g. Mesa llvmpipe in CI.
+class GLContext
+{
+    protected:
+        GLContextDesc m_Desc;
+        unsigned int m_FrameCount;
+
+        explicit GLContext(const GLContextDesc& desc) : m_Desc(desc), m_FrameCount(0) {}
+
+        virtual void* GetProcAddress(const char* name) const = 0;
+        virtual void Present() = 0;
+        virtual bool OnLoaded() { return true; }
+
+    public:
+        // Returns nullptr (after printing why) when no context can be created.
+        static std::unique_ptr<GLContext> Create(const GLContextDesc& desc);
+        virtual ~GLContext() = default;
+
+        GLContext(const GLContext&) = delete;
+        GLContext& operator=(const GLContext&) = delete;
+
+        // Loads GL entry points for this context; call once after Create.
+        bool LoadGL();
+
+        virtual bool ShouldClose() const;
+        virtual void PollEvents() {}
+        virtual void SetSwapInterval(int interval) { (void)interval; }
+        // Counts the frame, captures it if it is the last one, then presents.
+        void SwapBuffers();
+
+        // Returns nullptr (after printing why) if the backend cannot share.
+        virtual std::unique_ptr<GLSharedContext> CreateSharedContext() { return nullptr; }
+
+        // Reads the current read framebuffer back into a binary PPM.
+        bool Capture(const std::string& path) const;
+
+        // The GLFW window, or nullptr for headless contexts.
+        virtual GLFWwindow* GetWindow() const { return nullptr; }
+
+        inline const GLContextDesc& GetDesc() const { return m_Desc; }
+        inline unsigned int GetFrameCount() const { return m_FrameCount; }
+        inline bool IsHeadless() const { return m_Desc.headless; }
+};
@@ -0,0 +1,250 @@
+#include "GLContext.h"
+#include <iostream>
+
+#if GLCOMMON_HAS_EGL
+
+#include "GLDebug.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+
+namespace
+{
+    bool HasExtension(const char* extensions, const char* name)
+    {
+        if (!extensions)
+            return false;
+        size_t length = std::strlen(name);
+        for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name))
+            if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+                return true;
+        return false;
+    }
+
+    // Prefers Mesa's surfaceless platform, which needs neither X11 nor a GPU.
+    EGLDisplay OpenDisplay()
+    {
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+        {
+            auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+            if (getPlatformDisplay)
+            {
+                EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+                if (display != EGL_NO_DISPLAY)
+                    return display;
+            }
+        }
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLContext CreateContext(EGLDisplay display, EGLConfig config, EGLContext share, bool debug)
+    {
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_CONTEXT_OPENGL_DEBUG, debug ? EGL_TRUE : EGL_FALSE,
+            EGL_NONE
+        };
+        return eglCreateContext(display, config, share, contextAttribs);
+    }
+
+    class EglSharedContext : public GLSharedContext
+    {
+        private:
+            EGLDisplay m_Display;
+            EGLContext m_Context;
+            EGLSurface m_Surface;
+
+        public:
+            EglSharedContext(EGLDisplay display, EGLContext context, EGLSurface surface)
+                : m_Display(display), m_Context(context), m_Surface(surface) {}
+
+            ~EglSharedContext() override
+            {
+                if (m_Surface != EGL_NO_SURFACE)
+                    eglDestroySurface(m_Display, m_Surface);
+                eglDestroyContext(m_Display, m_Context);
+            }
+
+            bool MakeCurrent() override
+            {
+                // eglBindAPI is per thread.
+                eglBindAPI(EGL_OPENGL_API);
+                return eglMakeCurrent(m_Display, m_Surface, m_Surface, m_Context);
+            }
+
+            void DoneCurrent() override
+            {
+                eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            }
+    };
+
+    class EglContext : public GLContext
+    {
+        private:
+            EGLDisplay m_Display;
+            EGLConfig m_Config;
+            EGLContext m_Context;
+            EGLSurface m_Surface;
+            unsigned int m_Framebuffer;
+            unsigned int m_Renderbuffers[2];
+
+        protected:
+            void* GetProcAddress(const char* name) const override
+            {
+                return (void*)eglGetProcAddress(name);
+            }
+
+            // Nothing is displayed; flushing keeps frame pacing comparable
+            // to a real swap without waiting for the GPU.
+            void Present() override
+            {
+                GLCall(glFlush());
+            }
+
+            // Surfaceless contexts have no default framebuffer, so everything
+            // renders into an FBO that stays bound for the context's lifetime.
+            bool OnLoaded() override
+            {
+                GLCall(glGenRenderbuffers(2, m_Renderbuffers));
+                GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_Renderbuffers[0]));
+                GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, m_Desc.width, m_Desc.height));
+                GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_Renderbuffers[1]));
+                GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, m_Desc.width, m_Desc.height));
+                GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+
+                GLCall(glGenFramebuffers(1, &m_Framebuffer));
+                GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer));
+                GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_Renderbuffers[0]));
+                GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_Renderbuffers[1]));
+                if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                {
+                    std::cerr << "Headless framebuffer is incomplete" << std::endl;
+                    return false;
+                }
+                GLCall(glViewport(0, 0, m_Desc.width, m_Desc.height));
+                return true;
+            }
+
+        public:
+            EglContext(const GLContextDesc& desc, EGLDisplay display, EGLConfig config, EGLContext context, EGLSurface surface)
+                : GLContext(desc), m_Display(display), m_Config(config), m_Context(context), m_Surface(surface),
+                  m_Framebuffer(0), m_Renderbuffers{0, 0} {}
+
+            ~EglContext() override
+            {
+                if (m_Framebuffer)
+                {
+                    GLCall(glDeleteFramebuffers(1, &m_Framebuffer));
+                    GLCall(glDeleteRenderbuffers(2, m_Renderbuffers));
+                }
+                eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+                if (m_Surface != EGL_NO_SURFACE)
+                    eglDestroySurface(m_Display, m_Surface);
+                eglDestroyContext(m_Display, m_Context);
+                eglTerminate(m_Display);
+            }
+
+            std::unique_ptr<GLSharedContext> CreateSharedContext() override
+            {
+                EGLContext context = CreateContext(m_Display, m_Config, m_Context, m_Desc.debug);
+                if (context == EGL_NO_CONTEXT)
+                {
+                    std::cerr << "Failed to create shared EGL context" << std::endl;
+                    return nullptr;
+                }
+                // Mirror the main context: surfaceless if it is, else a tiny pbuffer.
+                EGLSurface surface = EGL_NO_SURFACE;
+                if (m_Surface != EGL_NO_SURFACE)
+                {
+                    const EGLint surfaceAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+                    surface = eglCreatePbufferSurface(m_Display, m_Config, surfaceAttribs);
+                    if (surface == EGL_NO_SURFACE)
+                    {
+                        std::cerr << "Failed to create shared EGL pbuffer" << std::endl;
+                        eglDestroyContext(m_Display, context);
+                        return nullptr;
+                    }
+                }
+                return std::make_unique<EglSharedContext>(m_Display, context, surface);
+            }
+    };
+}
+
+std::unique_ptr<GLContext> CreateEglContext(const GLContextDesc& desc)
+{
+    EGLDisplay display = OpenDisplay();
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cerr << "Failed to initialize EGL" << std::endl;
+        return nullptr;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    bool surfaceless = HasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    // The surfaceless platform exposes no pbuffer configs; accept any config there.
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+    {
+        const EGLint anyConfig[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        if (!surfaceless || !eglChooseConfig(display, anyConfig, &config, 1, &configCount) || configCount == 0)
+        {
+            std::cerr << "No suitable EGL config" << std::endl;
+            eglTerminate(display);
+            return nullptr;
+        }
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+    EGLContext context = CreateContext(display, config, EGL_NO_CONTEXT, desc.debug);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cerr << "Failed to create EGL context" << std::endl;
+        eglTerminate(display);
+        return nullptr;
+    }
+
+    EGLSurface surface = EGL_NO_SURFACE;
+    if (!surfaceless)
+    {
+        const EGLint surfaceAttribs[] = { EGL_WIDTH, desc.width, EGL_HEIGHT, desc.height, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+        if (surface == EGL_NO_SURFACE)
+        {
+            std::cerr << "Failed to create EGL pbuffer" << std::endl;
+            eglDestroyContext(display, context);
+            eglTerminate(display);
+            return nullptr;
+        }
+    }
+
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        std::cerr << "Failed to make EGL context current" << std::endl;
+        if (surface != EGL_NO_SURFACE)
+            eglDestroySurface(display, surface);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        return nullptr;
+    }
+    return std::make_unique<EglContext>(desc, display, config, context, surface);
+}
+
+#else
+
+std::unique_ptr<GLContext> CreateEglContext(const GLContextDesc&)
+{
+    std::cerr << "Headless rendering needs EGL; rebuild with EGL available" << std::endl;
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "GLContext.h"
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+namespace
+{
+    // GLFW only creates contexts together with a window, so the shared
+    // context is an invisible 1x1 window; only its context is used.
+    class GlfwSharedContext : public GLSharedContext
+    {
+        private:
+            GLFWwindow* m_Window;
+
+        public:
+            explicit GlfwSharedContext(GLFWwindow* window) : m_Window(window) {}
+
+            ~GlfwSharedContext() override
+            {
+                glfwDestroyWindow(m_Window);
+            }
+
+            bool MakeCurrent() override
+            {
+                glfwMakeContextCurrent(m_Window);
+                return glfwGetCurrentContext() == m_Window;
+            }
+
+            void DoneCurrent() override
+            {
+                glfwMakeContextCurrent(nullptr);
+            }
+    };
+
+    class GlfwContext : public GLContext
+    {
+        private:
+            GLFWwindow* m_Window;
+
+        protected:
+            void* GetProcAddress(const char* name) const override
+            {
+                return (void*)glfwGetProcAddress(name);
+            }
+
+            void Present() override
+            {
+                glfwSwapBuffers(m_Window);
+            }
+
+        public:
+            GlfwContext(const GLContextDesc& desc, GLFWwindow* window)
+                : GLContext(desc), m_Window(window) {}
+
+            ~GlfwContext() override
+            {
+                glfwDestroyWindow(m_Window);
+                glfwTerminate();
+            }
+
+            bool ShouldClose() const override
+            {
+                return glfwWindowShouldClose(m_Window) || GLContext::ShouldClose();
+            }
+
+            void PollEvents() override
+            {
+                glfwPollEvents();
+            }
+
+            void SetSwapInterval(int interval) override
+            {
+                glfwSwapInterval(interval);
+            }
+
+            std::unique_ptr<GLSharedContext> CreateSharedContext() override
+            {
+                // The remaining hints are still those used for m_Window.
+                glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+                GLFWwindow* window = glfwCreateWindow(1, 1, "", nullptr, m_Window);
+                glfwWindowHint(GLFW_VISIBLE, m_Desc.visible ? GLFW_TRUE : GLFW_FALSE);
+                if (!window)
+                {
+                    std::cerr << "Failed to create shared GLFW context" << std::endl;
+                    return nullptr;
+                }
+                return std::make_unique<GlfwSharedContext>(window);
+            }
+
+            GLFWwindow* GetWindow() const override { return m_Window; }
+    };
+}
+
+std::unique_ptr<GLContext> CreateGlfwContext(const GLContextDesc& desc)
+{
+    if (!glfwInit())
+    {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return nullptr;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, desc.debug ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_VISIBLE, desc.visible ? GLFW_TRUE : GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(desc.width, desc.height, desc.title, nullptr, nullptr);
+    if (!window)
+    {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return nullptr;
+    }
+
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(desc.vsync ? 1 : 0);
+    return std::make_unique<GlfwContext>(desc, window);
+}
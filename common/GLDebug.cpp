@@ -0,0 +1,66 @@
+#include "GLDebug.h"
+#include <iostream>
+
+thread_local GLCallSite g_GLCallSite = {nullptr, nullptr, 0};
+
+void GLClearError()
+{
+    while (glGetError() != GL_NO_ERROR);
+}
+bool GLLogCall(const char* function, const char* file, int line)
+{
+    while(GLenum error = glGetError())
+    {
+        std::cout << "[OpenGL Error] (" <<  error << "): " << function << " " << file << ";" << line << std::endl; 
+        return false;
+    }
+    return true;
+}
+
+#if defined(GL_VERSION_4_3) || defined(GL_KHR_debug)
+static void APIENTRY GLDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                    GLsizei length, const GLchar* message, const void* userParam)
+{
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        return;
+
+    // The tag belongs to whichever thread the driver reports on; drivers that
+    // defer reporting to their own thread leave it empty.
+    const GLCallSite& site = g_GLCallSite;
+    std::cout << "[OpenGL Debug] (" << id << "): " << message;
+    if (site.function)
+        std::cout << " near " << site.function << " " << site.file << ";" << site.line;
+    std::cout << std::endl;
+
+    if (type == GL_DEBUG_TYPE_ERROR && severity == GL_DEBUG_SEVERITY_HIGH)
+        GL_DEBUG_BREAK();
+}
+#endif
+
+bool GLDebugInstallCallback()
+{
+    bool supported = false;
+#if defined(GL_VERSION_4_3)
+    supported = supported || GLAD_GL_VERSION_4_3;
+#endif
+#if defined(GL_KHR_debug)
+    supported = supported || GLAD_GL_KHR_debug;
+#endif
+    if (!supported)
+        return false;
+
+#if defined(GL_VERSION_4_3) || defined(GL_KHR_debug)
+    glEnable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(GLDebugMessage, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+#endif
+    return true;
+}
+
+void GLDebugInit()
+{
+#if GL_DEBUG_POLICY == GL_DEBUG_POLICY_ASYNC
+    if (!GLDebugInstallCallback())
+        std::cerr << "GL debug output unavailable, GLCall errors will not be reported" << std::endl;
+#endif
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "glad/glad.h"
+
+// GL_DEBUG_POLICY selects how GLCall reports GL errors:
+//   GL_DEBUG_POLICY_OFF    - GLCall(x) is exactly x, nothing is checked
+//   GL_DEBUG_POLICY_ASYNC  - errors come from the driver through the
+//                            KHR_debug callback, each GLCall only tags the
+//                            current call site in a thread-local
+//   GL_DEBUG_POLICY_STRICT - glGetError before and after every call
+// Release builds default to OFF and everything else to STRICT; profiling
+// builds (RelWithDebInfo) get ASYNC from common/CMakeLists.txt.
+#define GL_DEBUG_POLICY_OFF    0
+#define GL_DEBUG_POLICY_ASYNC  1
+#define GL_DEBUG_POLICY_STRICT 2
+
+#ifndef GL_DEBUG_POLICY
+    #ifdef NDEBUG
+        #define GL_DEBUG_POLICY GL_DEBUG_POLICY_OFF
+    #else
+        #define GL_DEBUG_POLICY GL_DEBUG_POLICY_STRICT
+    #endif
+#endif
+
+#if defined(_MSC_VER)
+    #define GL_DEBUG_BREAK() __debugbreak()
+#else
+    #include <csignal>
+    #define GL_DEBUG_BREAK() std::raise(SIGTRAP)
+#endif
+
+#define ASSERT(x) if(!(x)) GL_DEBUG_BREAK();
+
+// GL_CALL_STATS additionally times the wrapped call itself (not the error
+// checks around it) into a per-call-site histogram, see GLCallStats.h.
+#ifndef GL_CALL_STATS
+    #define GL_CALL_STATS 0
+#endif
+
+#if GL_CALL_STATS
+    #include "GLCallStats.h"
+    #define GLCALL_INVOKE(x) do { \
+        static GLCallSiteStats glCallSiteStats(#x, __FILE__, __LINE__); \
+        GLCallTimer glCallTimer(glCallSiteStats); \
+        x; \
+    } while (0)
+#else
+    #define GLCALL_INVOKE(x) x
+#endif
+
+struct GLCallSite
+{
+    const char* function;
+    const char* file;
+    int line;
+};
+
+// Last call site entered through GLCALL_ASYNC on this thread.
+extern thread_local GLCallSite g_GLCallSite;
+
+#define GLCALL_OFF(x) GLCALL_INVOKE(x)
+
+#define GLCALL_ASYNC(x) do { \
+    g_GLCallSite = {#x, __FILE__, __LINE__}; \
+    GLCALL_INVOKE(x); \
+} while (0)
+
+#define GLCALL_STRICT(x) do { \
+    GLClearError(); \
+    GLCALL_INVOKE(x); \
+    ASSERT(GLLogCall(#x, __FILE__, __LINE__)) \
+} while (0)
+
+#if GL_DEBUG_POLICY == GL_DEBUG_POLICY_STRICT
+    #define GLCall(x) GLCALL_STRICT(x)
+#elif GL_DEBUG_POLICY == GL_DEBUG_POLICY_ASYNC
+    #define GLCall(x) GLCALL_ASYNC(x)
+#else
+    #define GLCall(x) GLCALL_OFF(x)
+#endif
+
+void GLClearError();
+bool GLLogCall(const char* function, const char* file, int line);
+
+// Installs the KHR_debug message callback. Returns false when the context
+// has neither GL 4.3 nor KHR_debug; GLCall then reports nothing in ASYNC mode.
+bool GLDebugInstallCallback();
+
+// Call once after the loader is initialised. Installs the callback when the
+// active policy needs it.
+void GLDebugInit();
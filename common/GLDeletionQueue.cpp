@@ -0,0 +1,133 @@
+#include "GLDeletionQueue.h"
+#include "GLDebug.h"
+#include "GLStateCache.h"
+
+namespace
+{
+    bool HasSync()
+    {
+        bool supported = false;
+#if defined(GL_VERSION_3_2)
+        supported = supported || GLAD_GL_VERSION_3_2;
+#endif
+#if defined(GL_ARB_sync)
+        supported = supported || GLAD_GL_ARB_sync;
+#endif
+        return supported;
+    }
+}
+
+bool GLDeletionQueue::Batch::IsEmpty() const
+{
+    for (const std::vector<unsigned int>& list : names)
+        if (!list.empty())
+            return false;
+    return callbacks.empty();
+}
+
+GLDeletionQueue::GLDeletionQueue()
+    : m_Frame(0), m_Pending(0)
+{
+}
+
+GLDeletionQueue& GLDeletionQueue::Get()
+{
+    static GLDeletionQueue queue;
+    return queue;
+}
+
+void GLDeletionQueue::Delete(Kind kind, unsigned int name)
+{
+    if (name == 0)
+        return;
+    m_Current.names[kind].push_back(name);
+    m_Pending++;
+}
+
+void GLDeletionQueue::Defer(std::function<void()> release)
+{
+    m_Current.callbacks.push_back(std::move(release));
+    m_Pending++;
+}
+
+bool GLDeletionQueue::IsComplete(const Batch& batch) const
+{
+    if (!batch.fence)
+        return m_Frame - batch.frame >= FRAMES_IN_FLIGHT;
+
+    GLenum result;
+    GLCall(result = glClientWaitSync(batch.fence, 0, 0));
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void GLDeletionQueue::Release(Batch& batch)
+{
+    GLStateCache& state = GLStateCache::Get();
+
+    std::vector<unsigned int>& buffers = batch.names[BUFFER];
+    if (!buffers.empty())
+    {
+        GLCall(glDeleteBuffers((GLsizei)buffers.size(), buffers.data()));
+        for (unsigned int name : buffers)
+            state.OnDeleteBuffer(name);
+    }
+    std::vector<unsigned int>& vertexArrays = batch.names[VERTEX_ARRAY];
+    if (!vertexArrays.empty())
+    {
+        GLCall(glDeleteVertexArrays((GLsizei)vertexArrays.size(), vertexArrays.data()));
+        for (unsigned int name : vertexArrays)
+            state.OnDeleteVertexArray(name);
+    }
+    std::vector<unsigned int>& textures = batch.names[TEXTURE];
+    if (!textures.empty())
+    {
+        GLCall(glDeleteTextures((GLsizei)textures.size(), textures.data()));
+        for (unsigned int name : textures)
+            state.OnDeleteTexture(name);
+    }
+    for (unsigned int name : batch.names[PROGRAM])
+    {
+        GLCall(glDeleteProgram(name));
+        state.OnDeleteProgram(name);
+    }
+    for (std::function<void()>& release : batch.callbacks)
+        release();
+
+    for (std::vector<unsigned int>& list : batch.names)
+        m_Pending -= (unsigned int)list.size();
+    m_Pending -= (unsigned int)batch.callbacks.size();
+
+    if (batch.fence)
+        GLCall(glDeleteSync(batch.fence));
+}
+
+void GLDeletionQueue::EndFrame()
+{
+    if (!m_Current.IsEmpty())
+    {
+        m_Current.frame = m_Frame;
+        if (HasSync())
+            GLCall(m_Current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        m_InFlight.push_back(std::move(m_Current));
+        m_Current = Batch();
+    }
+    m_Frame++;
+
+    // Fences signal in submission order, so stop at the first busy batch.
+    while (!m_InFlight.empty() && IsComplete(m_InFlight.front()))
+    {
+        Release(m_InFlight.front());
+        m_InFlight.pop_front();
+    }
+}
+
+void GLDeletionQueue::Flush()
+{
+    while (!m_InFlight.empty())
+    {
+        Release(m_InFlight.front());
+        m_InFlight.pop_front();
+    }
+    Release(m_Current);
+    m_Current = Batch();
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Defers glDelete* until the GPU is done with the object.
+//
+// Objects released during a frame are collected into a batch; EndFrame puts
+// a fence behind the frame's commands and deletes every batch whose fence
+// has signaled, one glDelete* call per object kind. Without sync objects
+// (pre 3.2) a batch is released FRAMES_IN_FLIGHT frames later instead.
+// Releasing mid-frame therefore never makes the driver wait, and sub-ranges
+// of shared buffers are not handed out again while still being read.
+//
+// Only use from the thread that owns the context. Flush before the context
+// (or anything a Defer callback touches) is destroyed.
+class GLDeletionQueue
+{
+    public:
+        enum Kind
+        {
+            BUFFER, VERTEX_ARRAY, TEXTURE, PROGRAM, KIND_COUNT
+        };
+
+        static constexpr unsigned int FRAMES_IN_FLIGHT = 3;
+
+    private:
+        struct Batch
+        {
+            GLsync fence = nullptr;
+            unsigned long long frame = 0;
+            std::vector<unsigned int> names[KIND_COUNT];
+            std::vector<std::function<void()>> callbacks;
+
+            bool IsEmpty() const;
+        };
+
+        Batch m_Current;
+        std::deque<Batch> m_InFlight;
+        unsigned long long m_Frame;
+        unsigned int m_Pending;
+
+        GLDeletionQueue();
+
+        bool IsComplete(const Batch& batch) const;
+        void Release(Batch& batch);
+
+    public:
+        static GLDeletionQueue& Get();
+
+        void Delete(Kind kind, unsigned int name);
+        // Runs release once the current frame has completed on the GPU.
+        void Defer(std::function<void()> release);
+
+        // Call once per frame after the last draw, before swapping.
+        void EndFrame();
+        // Deletes everything now. The GL still defers any object in use.
+        void Flush();
+
+        inline unsigned int GetPendingCount() const { return m_Pending; }
+};
@@ -0,0 +1,152 @@
+#include "GLStateCache.h"
+#include "GLDebug.h"
+#include <iomanip>
+
+GLStateCache::GLStateCache()
+{
+    Invalidate();
+}
+
+GLStateCache& GLStateCache::Get()
+{
+    static GLStateCache cache;
+    return cache;
+}
+
+bool GLStateCache::Update(unsigned int& cached, unsigned int value, Counter counter)
+{
+    if (cached == value)
+    {
+        m_Stats.filtered[counter]++;
+        return false;
+    }
+    cached = value;
+    m_Stats.issued[counter]++;
+    return true;
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+    if (Update(m_Program, program, PROGRAM))
+        GLCall(glUseProgram(program));
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+    if (Update(m_VertexArray, vertexArray, VERTEX_ARRAY))
+        GLCall(glBindVertexArray(vertexArray));
+}
+
+void GLStateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    unsigned int* cached;
+    if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        // Unknown VAO means unknown element binding too.
+        if (m_VertexArray == UNKNOWN)
+        {
+            m_Stats.issued[BUFFER]++;
+            GLCall(glBindBuffer(target, buffer));
+            return;
+        }
+        cached = &m_ElementBuffers.emplace(m_VertexArray, UNKNOWN).first->second;
+    }
+    else
+    {
+        cached = &m_Buffers.emplace(target, UNKNOWN).first->second;
+    }
+
+    if (Update(*cached, buffer, BUFFER))
+        GLCall(glBindBuffer(target, buffer));
+}
+
+void GLStateCache::ActiveTexture(unsigned int unit)
+{
+    if (Update(m_ActiveTexture, unit, ACTIVE_TEXTURE))
+        GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+}
+
+void GLStateCache::BindTexture(unsigned int unit, unsigned int target, unsigned int texture)
+{
+    unsigned int& cached = m_Textures.emplace(((unsigned long long)unit << 32) | target, UNKNOWN).first->second;
+    if (cached == texture)
+    {
+        m_Stats.filtered[TEXTURE]++;
+        return;
+    }
+    ActiveTexture(unit);
+    Update(cached, texture, TEXTURE);
+    GLCall(glBindTexture(target, texture));
+}
+
+void GLStateCache::OnDeleteProgram(unsigned int program)
+{
+    // The current program stays in use after deletion, but its name can be
+    // recycled by glCreateProgram, so the next UseProgram must be issued.
+    if (m_Program == program)
+        m_Program = UNKNOWN;
+}
+
+void GLStateCache::OnDeleteVertexArray(unsigned int vertexArray)
+{
+    if (m_VertexArray == vertexArray)
+        m_VertexArray = 0;
+    m_ElementBuffers.erase(vertexArray);
+}
+
+void GLStateCache::OnDeleteBuffer(unsigned int buffer)
+{
+    for (auto& binding : m_Buffers)
+        if (binding.second == buffer)
+            binding.second = 0;
+    // Only the bound VAO loses the attachment; others keep the stale name
+    // until rebound, so treat them as unknown.
+    for (auto& binding : m_ElementBuffers)
+        if (binding.second == buffer)
+            binding.second = binding.first == m_VertexArray ? 0 : UNKNOWN;
+}
+
+void GLStateCache::ForgetBuffer(unsigned int buffer)
+{
+    for (auto& binding : m_Buffers)
+        if (binding.second == buffer)
+            binding.second = UNKNOWN;
+    for (auto& binding : m_ElementBuffers)
+        if (binding.second == buffer)
+            binding.second = UNKNOWN;
+}
+
+void GLStateCache::OnDeleteTexture(unsigned int texture)
+{
+    for (auto& binding : m_Textures)
+        if (binding.second == texture)
+            binding.second = 0;
+}
+
+void GLStateCache::Invalidate()
+{
+    m_Program = UNKNOWN;
+    m_VertexArray = UNKNOWN;
+    m_ActiveTexture = UNKNOWN;
+    m_Buffers.clear();
+    m_ElementBuffers.clear();
+    m_Textures.clear();
+}
+
+void GLStateCache::Report(std::ostream& out) const
+{
+    static const char* names[COUNTER_COUNT] = {"program", "vertex array", "buffer", "active texture", "texture"};
+
+    unsigned long long issued = 0, filtered = 0;
+    out << "GL binds issued / filtered\n";
+    for (int i = 0; i < COUNTER_COUNT; i++)
+    {
+        out << std::setw(16) << names[i] << std::setw(10) << m_Stats.issued[i] << std::setw(10) << m_Stats.filtered[i] << "\n";
+        issued += m_Stats.issued[i];
+        filtered += m_Stats.filtered[i];
+    }
+    out << std::setw(16) << "total" << std::setw(10) << issued << std::setw(10) << filtered;
+    if (issued + filtered)
+        out << "  (" << 100.0 * filtered / (issued + filtered) << "% filtered)";
+    out << std::endl;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <ostream>
+#include <unordered_map>
+
+// Shadow copy of the binding state of the current context.
+//
+// Every bind in the samples goes through here so that a bind of the object
+// that is already bound never reaches the driver. Element array bindings are
+// VAO state and are tracked per VAO. Code that binds behind the cache's back
+// must call Invalidate() afterwards; deleting a tracked object must be
+// reported with the matching OnDelete* call so a recycled name is rebound.
+class GLStateCache
+{
+    public:
+        enum Counter
+        {
+            PROGRAM, VERTEX_ARRAY, BUFFER, ACTIVE_TEXTURE, TEXTURE, COUNTER_COUNT
+        };
+
+        struct Stats
+        {
+            unsigned long long issued[COUNTER_COUNT] = {};
+            unsigned long long filtered[COUNTER_COUNT] = {};
+        };
+
+    private:
+        static constexpr unsigned int UNKNOWN = ~0u;
+
+        unsigned int m_Program;
+        unsigned int m_VertexArray;
+        unsigned int m_ActiveTexture;
+        // target -> buffer, except GL_ELEMENT_ARRAY_BUFFER
+        std::unordered_map<unsigned int, unsigned int> m_Buffers;
+        // VAO -> element array buffer
+        std::unordered_map<unsigned int, unsigned int> m_ElementBuffers;
+        // (unit << 32 | target) -> texture
+        std::unordered_map<unsigned long long, unsigned int> m_Textures;
+        Stats m_Stats;
+
+        GLStateCache();
+
+        bool Update(unsigned int& cached, unsigned int value, Counter counter);
+
+    public:
+        static GLStateCache& Get();
+
+        void UseProgram(unsigned int program);
+        void BindVertexArray(unsigned int vertexArray);
+        void BindBuffer(unsigned int target, unsigned int buffer);
+        // unit is zero based, i.e. GL_TEXTURE0 + unit.
+        void ActiveTexture(unsigned int unit);
+        // Only guarantees the binding; a filtered call leaves the active unit
+        // alone, so call ActiveTexture before glTexParameter/glTexImage.
+        void BindTexture(unsigned int unit, unsigned int target, unsigned int texture);
+
+        void OnDeleteProgram(unsigned int program);
+        void OnDeleteVertexArray(unsigned int vertexArray);
+        void OnDeleteBuffer(unsigned int buffer);
+        void OnDeleteTexture(unsigned int texture);
+        // Forgets where buffer is bound, so the next bind reaches the driver.
+        // Writes from a shared context only become visible after a rebind.
+        void ForgetBuffer(unsigned int buffer);
+
+        // Forget everything; the next bind of each kind is always issued.
+        void Invalidate();
+
+        inline const Stats& GetStats() const { return m_Stats; }
+        void ResetStats() { m_Stats = Stats(); }
+        void Report(std::ostream& out) const;
+};
@@ -0,0 +1,1128 @@
+#include "GLTrace.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // An open glMapBufferRange whose contents go into the UnmapBuffer record.
+    struct Mapping
+    {
+        const uint8_t* pointer;
+        int64_t length;
+        GLbitfield access;
+    };
+
+    struct Recorder
+    {
+        std::ofstream file;
+        // target -> open mapping, persistent ones excluded
+        std::unordered_map<GLenum, Mapping> mappings;
+        std::vector<uint8_t> pending;
+        Clock::time_point start;
+        std::mutex mutex;
+        bool recording = false;
+    };
+
+    Recorder s_Recorder;
+
+    // Original loader pointers, restored by GLTraceEnd.
+#define GLTRACE_REAL(name) decltype(glad_gl##name) s_Real##name;
+    GLTRACE_FUNCTIONS_CORE(GLTRACE_REAL)
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+    GLTRACE_FUNCTIONS_BUFFER_STORAGE(GLTRACE_REAL)
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+    GLTRACE_FUNCTIONS_ATTRIB_BINDING(GLTRACE_REAL)
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+    GLTRACE_FUNCTIONS_MULTI_DRAW_INDIRECT(GLTRACE_REAL)
+#endif
+#undef GLTRACE_REAL
+
+    constexpr size_t FLUSH_THRESHOLD = 1 << 20;
+    constexpr size_t RECORD_HEADER_SIZE = sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint64_t);
+
+    template<typename T>
+    void Append(std::vector<uint8_t>& out, const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "trace values must be POD");
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    void FlushPending()
+    {
+        s_Recorder.file.write(reinterpret_cast<const char*>(s_Recorder.pending.data()), s_Recorder.pending.size());
+        s_Recorder.pending.clear();
+    }
+
+    // Appends one record to the pending block. The header goes in first and
+    // its payload size is patched once the record goes out of scope, so a
+    // record is always built as a single full expression:
+    //   (Record(func) << a << b).Blob(data, size);
+    class Record
+    {
+        private:
+            std::lock_guard<std::mutex> m_Lock;
+            size_t m_Start;
+
+        public:
+            explicit Record(GLTraceFunc func)
+                : m_Lock(s_Recorder.mutex), m_Start(s_Recorder.pending.size())
+            {
+                uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - s_Recorder.start).count();
+                Append(s_Recorder.pending, static_cast<uint16_t>(func));
+                Append(s_Recorder.pending, uint32_t(0));
+                Append(s_Recorder.pending, timestamp);
+            }
+
+            ~Record()
+            {
+                uint32_t size = static_cast<uint32_t>(s_Recorder.pending.size() - m_Start - RECORD_HEADER_SIZE);
+                std::memcpy(&s_Recorder.pending[m_Start + sizeof(uint16_t)], &size, sizeof(size));
+                if (s_Recorder.pending.size() >= FLUSH_THRESHOLD)
+                    FlushPending();
+            }
+
+            template<typename T>
+            Record& operator<<(const T& value) { Append(s_Recorder.pending, value); return *this; }
+
+            // uint64 length followed by the bytes; a null pointer records length 0.
+            Record& Blob(const void* data, uint64_t size)
+            {
+                if (!data)
+                    size = 0;
+                Append(s_Recorder.pending, size);
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                s_Recorder.pending.insert(s_Recorder.pending.end(), bytes, bytes + size);
+                return *this;
+            }
+
+            Record& Names(GLsizei n, const GLuint* names)
+            {
+                return Blob(names, n * sizeof(GLuint));
+            }
+    };
+
+    unsigned int BytesPerPixel(GLenum format, GLenum type)
+    {
+        unsigned int components = 4;
+        switch (format)
+        {
+            case GL_RED: components = 1; break;
+            case GL_RG: components = 2; break;
+            case GL_RGB: case GL_BGR: components = 3; break;
+        }
+        switch (type)
+        {
+            case GL_FLOAT: return components * 4;
+            case GL_HALF_FLOAT: case GL_UNSIGNED_SHORT: case GL_SHORT: return components * 2;
+        }
+        return components;
+    }
+
+    // Size of a client-side image with the default GL_UNPACK_ALIGNMENT of 4.
+    uint64_t ImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+    {
+        uint64_t row = (uint64_t)width * BytesPerPixel(format, type);
+        row = (row + 3) & ~uint64_t(3);
+        return row * height;
+    }
+
+    // Recording thunks. Each forwards to the driver first so generated names
+    // and returned locations can be stored alongside the arguments.
+    void APIENTRY TraceGenBuffers(GLsizei n, GLuint* buffers)
+    {
+        s_RealGenBuffers(n, buffers);
+        Record(GLTraceFunc::GenBuffers).Names(n, buffers);
+    }
+    void APIENTRY TraceDeleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        s_RealDeleteBuffers(n, buffers);
+        Record(GLTraceFunc::DeleteBuffers).Names(n, buffers);
+    }
+    void APIENTRY TraceBindBuffer(GLenum target, GLuint buffer)
+    {
+        s_RealBindBuffer(target, buffer);
+        Record(GLTraceFunc::BindBuffer) << target << buffer;
+    }
+    void APIENTRY TraceBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+    {
+        s_RealBufferData(target, size, data, usage);
+        (Record(GLTraceFunc::BufferData) << target << usage << (int64_t)size).Blob(data, size);
+    }
+    void APIENTRY TraceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+        s_RealBufferSubData(target, offset, size, data);
+        (Record(GLTraceFunc::BufferSubData) << target << (int64_t)offset).Blob(data, size);
+    }
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+    void APIENTRY TraceBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+    {
+        s_RealBufferStorage(target, size, data, flags);
+        (Record(GLTraceFunc::BufferStorage) << target << flags << (int64_t)size).Blob(data, size);
+    }
+    constexpr GLbitfield PERSISTENT_BIT = GL_MAP_PERSISTENT_BIT;
+#else
+    constexpr GLbitfield PERSISTENT_BIT = 0;
+#endif
+    void* APIENTRY TraceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+        void* pointer = s_RealMapBufferRange(target, offset, length, access);
+        Record record(GLTraceFunc::MapBufferRange);
+        record << target << access << (int64_t)offset << (int64_t)length;
+        if (pointer && !(access & PERSISTENT_BIT))
+            s_Recorder.mappings[target] = {static_cast<const uint8_t*>(pointer), (int64_t)length, access};
+        return pointer;
+    }
+    void APIENTRY TraceFlushMappedBufferRange(GLenum target, GLintptr offset, GLsizeiptr length)
+    {
+        {
+            // offset is relative to the start of the mapping.
+            Record record(GLTraceFunc::FlushMappedBufferRange);
+            record << target << (int64_t)offset;
+            auto it = s_Recorder.mappings.find(target);
+            if (it != s_Recorder.mappings.end() && offset >= 0 && offset + length <= it->second.length)
+                record.Blob(it->second.pointer + offset, length);
+            else
+                record.Blob(nullptr, 0);
+        }
+        s_RealFlushMappedBufferRange(target, offset, length);
+    }
+    GLboolean APIENTRY TraceUnmapBuffer(GLenum target)
+    {
+        {
+            // The bytes written through the mapping, unless they were flushed
+            // range by range.
+            Record record(GLTraceFunc::UnmapBuffer);
+            record << target;
+            auto it = s_Recorder.mappings.find(target);
+            if (it != s_Recorder.mappings.end() && (it->second.access & GL_MAP_WRITE_BIT) &&
+                !(it->second.access & GL_MAP_FLUSH_EXPLICIT_BIT))
+                record.Blob(it->second.pointer, it->second.length);
+            else
+                record.Blob(nullptr, 0);
+            if (it != s_Recorder.mappings.end())
+                s_Recorder.mappings.erase(it);
+        }
+        return s_RealUnmapBuffer(target);
+    }
+    GLsync APIENTRY TraceFenceSync(GLenum condition, GLbitfield flags)
+    {
+        GLsync sync = s_RealFenceSync(condition, flags);
+        Record(GLTraceFunc::FenceSync) << condition << flags << (uint64_t)(uintptr_t)sync;
+        return sync;
+    }
+    GLenum APIENTRY TraceClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+    {
+        GLenum result = s_RealClientWaitSync(sync, flags, timeout);
+        Record(GLTraceFunc::ClientWaitSync) << (uint64_t)(uintptr_t)sync << flags << (uint64_t)timeout;
+        return result;
+    }
+    void APIENTRY TraceDeleteSync(GLsync sync)
+    {
+        s_RealDeleteSync(sync);
+        Record(GLTraceFunc::DeleteSync) << (uint64_t)(uintptr_t)sync;
+    }
+    void APIENTRY TraceGenVertexArrays(GLsizei n, GLuint* arrays)
+    {
+        s_RealGenVertexArrays(n, arrays);
+        Record(GLTraceFunc::GenVertexArrays).Names(n, arrays);
+    }
+    void APIENTRY TraceDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+    {
+        s_RealDeleteVertexArrays(n, arrays);
+        Record(GLTraceFunc::DeleteVertexArrays).Names(n, arrays);
+    }
+    void APIENTRY TraceBindVertexArray(GLuint array)
+    {
+        s_RealBindVertexArray(array);
+        Record(GLTraceFunc::BindVertexArray) << array;
+    }
+    void APIENTRY TraceEnableVertexAttribArray(GLuint index)
+    {
+        s_RealEnableVertexAttribArray(index);
+        Record(GLTraceFunc::EnableVertexAttribArray) << index;
+    }
+    void APIENTRY TraceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+    {
+        s_RealVertexAttribPointer(index, size, type, normalized, stride, pointer);
+        Record(GLTraceFunc::VertexAttribPointer) << index << size << type << normalized << stride << (uint64_t)(uintptr_t)pointer;
+    }
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+    void APIENTRY TraceVertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+    {
+        s_RealVertexAttribFormat(attribindex, size, type, normalized, relativeoffset);
+        Record(GLTraceFunc::VertexAttribFormat) << attribindex << size << type << normalized << relativeoffset;
+    }
+    void APIENTRY TraceBindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+    {
+        s_RealBindVertexBuffer(bindingindex, buffer, offset, stride);
+        Record(GLTraceFunc::BindVertexBuffer) << bindingindex << buffer << (int64_t)offset << stride;
+    }
+    void APIENTRY TraceVertexAttribBinding(GLuint attribindex, GLuint bindingindex)
+    {
+        s_RealVertexAttribBinding(attribindex, bindingindex);
+        Record(GLTraceFunc::VertexAttribBinding) << attribindex << bindingindex;
+    }
+#endif
+    void APIENTRY TraceVertexAttribDivisor(GLuint index, GLuint divisor)
+    {
+        s_RealVertexAttribDivisor(index, divisor);
+        Record(GLTraceFunc::VertexAttribDivisor) << index << divisor;
+    }
+    GLuint APIENTRY TraceCreateShader(GLenum type)
+    {
+        GLuint shader = s_RealCreateShader(type);
+        Record(GLTraceFunc::CreateShader) << type << shader;
+        return shader;
+    }
+    void APIENTRY TraceShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+    {
+        s_RealShaderSource(shader, count, string, length);
+        std::string source;
+        for (GLsizei i = 0; i < count; i++)
+            source.append(string[i], (length && length[i] >= 0) ? (size_t)length[i] : std::strlen(string[i]));
+        (Record(GLTraceFunc::ShaderSource) << shader).Blob(source.data(), source.size());
+    }
+    void APIENTRY TraceCompileShader(GLuint shader)
+    {
+        s_RealCompileShader(shader);
+        Record(GLTraceFunc::CompileShader) << shader;
+    }
+    void APIENTRY TraceDeleteShader(GLuint shader)
+    {
+        s_RealDeleteShader(shader);
+        Record(GLTraceFunc::DeleteShader) << shader;
+    }
+    GLuint APIENTRY TraceCreateProgram()
+    {
+        GLuint program = s_RealCreateProgram();
+        Record(GLTraceFunc::CreateProgram) << program;
+        return program;
+    }
+    void APIENTRY TraceAttachShader(GLuint program, GLuint shader)
+    {
+        s_RealAttachShader(program, shader);
+        Record(GLTraceFunc::AttachShader) << program << shader;
+    }
+    void APIENTRY TraceLinkProgram(GLuint program)
+    {
+        s_RealLinkProgram(program);
+        Record(GLTraceFunc::LinkProgram) << program;
+    }
+    void APIENTRY TraceValidateProgram(GLuint program)
+    {
+        s_RealValidateProgram(program);
+        Record(GLTraceFunc::ValidateProgram) << program;
+    }
+    void APIENTRY TraceUseProgram(GLuint program)
+    {
+        s_RealUseProgram(program);
+        Record(GLTraceFunc::UseProgram) << program;
+    }
+    void APIENTRY TraceDeleteProgram(GLuint program)
+    {
+        s_RealDeleteProgram(program);
+        Record(GLTraceFunc::DeleteProgram) << program;
+    }
+    GLint APIENTRY TraceGetUniformLocation(GLuint program, const GLchar* name)
+    {
+        GLint location = s_RealGetUniformLocation(program, name);
+        (Record(GLTraceFunc::GetUniformLocation) << program << location).Blob(name, std::strlen(name));
+        return location;
+    }
+    void APIENTRY TraceUniform1i(GLint location, GLint v0)
+    {
+        s_RealUniform1i(location, v0);
+        Record(GLTraceFunc::Uniform1i) << location << v0;
+    }
+    void APIENTRY TraceUniform1f(GLint location, GLfloat v0)
+    {
+        s_RealUniform1f(location, v0);
+        Record(GLTraceFunc::Uniform1f) << location << v0;
+    }
+    void APIENTRY TraceUniform2f(GLint location, GLfloat v0, GLfloat v1)
+    {
+        s_RealUniform2f(location, v0, v1);
+        Record(GLTraceFunc::Uniform2f) << location << v0 << v1;
+    }
+    void APIENTRY TraceUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+    {
+        s_RealUniform3f(location, v0, v1, v2);
+        Record(GLTraceFunc::Uniform3f) << location << v0 << v1 << v2;
+    }
+    void APIENTRY TraceUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+    {
+        s_RealUniform4f(location, v0, v1, v2, v3);
+        Record(GLTraceFunc::Uniform4f) << location << v0 << v1 << v2 << v3;
+    }
+    void APIENTRY TraceUniform4fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        s_RealUniform4fv(location, count, value);
+        (Record(GLTraceFunc::Uniform4fv) << location).Blob(value, (uint64_t)count * 4 * sizeof(GLfloat));
+    }
+    void APIENTRY TraceUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        s_RealUniformMatrix4fv(location, count, transpose, value);
+        (Record(GLTraceFunc::UniformMatrix4fv) << location << transpose).Blob(value, (uint64_t)count * 16 * sizeof(GLfloat));
+    }
+    GLuint APIENTRY TraceGetUniformBlockIndex(GLuint program, const GLchar* name)
+    {
+        GLuint index = s_RealGetUniformBlockIndex(program, name);
+        (Record(GLTraceFunc::GetUniformBlockIndex) << program << index).Blob(name, std::strlen(name));
+        return index;
+    }
+    void APIENTRY TraceUniformBlockBinding(GLuint program, GLuint index, GLuint binding)
+    {
+        s_RealUniformBlockBinding(program, index, binding);
+        Record(GLTraceFunc::UniformBlockBinding) << program << index << binding;
+    }
+    void APIENTRY TraceBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        s_RealBindBufferRange(target, index, buffer, offset, size);
+        Record(GLTraceFunc::BindBufferRange) << target << index << buffer << (int64_t)offset << (int64_t)size;
+    }
+    void APIENTRY TraceGenTextures(GLsizei n, GLuint* textures)
+    {
+        s_RealGenTextures(n, textures);
+        Record(GLTraceFunc::GenTextures).Names(n, textures);
+    }
+    void APIENTRY TraceDeleteTextures(GLsizei n, const GLuint* textures)
+    {
+        s_RealDeleteTextures(n, textures);
+        Record(GLTraceFunc::DeleteTextures).Names(n, textures);
+    }
+    void APIENTRY TraceActiveTexture(GLenum texture)
+    {
+        s_RealActiveTexture(texture);
+        Record(GLTraceFunc::ActiveTexture) << texture;
+    }
+    void APIENTRY TraceBindTexture(GLenum target, GLuint texture)
+    {
+        s_RealBindTexture(target, texture);
+        Record(GLTraceFunc::BindTexture) << target << texture;
+    }
+    void APIENTRY TraceTexParameteri(GLenum target, GLenum pname, GLint param)
+    {
+        s_RealTexParameteri(target, pname, param);
+        Record(GLTraceFunc::TexParameteri) << target << pname << param;
+    }
+    void APIENTRY TraceTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                                  GLint border, GLenum format, GLenum type, const void* pixels)
+    {
+        s_RealTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+        (Record(GLTraceFunc::TexImage2D) << target << level << internalformat << width << height << border << format << type)
+            .Blob(pixels, ImageSize(width, height, format, type));
+    }
+    void APIENTRY TraceGenerateMipmap(GLenum target)
+    {
+        s_RealGenerateMipmap(target);
+        Record(GLTraceFunc::GenerateMipmap) << target;
+    }
+    void APIENTRY TraceClear(GLbitfield mask)
+    {
+        s_RealClear(mask);
+        Record(GLTraceFunc::Clear) << mask;
+    }
+    void APIENTRY TraceClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+    {
+        s_RealClearColor(red, green, blue, alpha);
+        Record(GLTraceFunc::ClearColor) << red << green << blue << alpha;
+    }
+    void APIENTRY TraceViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        s_RealViewport(x, y, width, height);
+        Record(GLTraceFunc::Viewport) << x << y << width << height;
+    }
+    void APIENTRY TraceDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+    {
+        s_RealDrawElements(mode, count, type, indices);
+        // Core profile: indices is always an offset into the element buffer.
+        Record(GLTraceFunc::DrawElements) << mode << count << type << (uint64_t)(uintptr_t)indices;
+    }
+    void APIENTRY TraceDrawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        s_RealDrawArrays(mode, first, count);
+        Record(GLTraceFunc::DrawArrays) << mode << first << count;
+    }
+    void APIENTRY TraceDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount)
+    {
+        s_RealDrawElementsInstanced(mode, count, type, indices, instancecount);
+        Record(GLTraceFunc::DrawElementsInstanced) << mode << count << type << (uint64_t)(uintptr_t)indices << instancecount;
+    }
+    void APIENTRY TraceDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex)
+    {
+        s_RealDrawElementsBaseVertex(mode, count, type, indices, basevertex);
+        Record(GLTraceFunc::DrawElementsBaseVertex) << mode << count << type << (uint64_t)(uintptr_t)indices << basevertex;
+    }
+    void APIENTRY TraceDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices,
+                                                       GLsizei instancecount, GLint basevertex)
+    {
+        s_RealDrawElementsInstancedBaseVertex(mode, count, type, indices, instancecount, basevertex);
+        Record(GLTraceFunc::DrawElementsInstancedBaseVertex) << mode << count << type << (uint64_t)(uintptr_t)indices
+                                                             << instancecount << basevertex;
+    }
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+    void APIENTRY TraceMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+    {
+        s_RealMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+        // The commands live in GL_DRAW_INDIRECT_BUFFER, whose uploads are
+        // already in the trace; indirect is an offset into it.
+        Record(GLTraceFunc::MultiDrawElementsIndirect) << mode << type << (uint64_t)(uintptr_t)indirect << drawcount << stride;
+    }
+#endif
+
+    // Sequential reader over one record payload.
+    class Reader
+    {
+        private:
+            const uint8_t* m_Data;
+            const uint8_t* m_End;
+
+        public:
+            Reader(const uint8_t* data, uint32_t size) : m_Data(data), m_End(data + size) {}
+
+            template<typename T>
+            T Read()
+            {
+                T value{};
+                if (m_Data + sizeof(T) <= m_End)
+                    std::memcpy(&value, m_Data, sizeof(T));
+                m_Data += sizeof(T);
+                return value;
+            }
+
+            // Returns nullptr for an empty blob.
+            const void* Blob(uint64_t& size)
+            {
+                size = Read<uint64_t>();
+                if (m_Data + size > m_End)
+                    size = 0;
+                const void* data = size ? m_Data : nullptr;
+                m_Data += size;
+                return data;
+            }
+    };
+}
+
+const char* GLTraceFuncName(GLTraceFunc func)
+{
+    static const char* names[] = {
+#define GLTRACE_NAME(name) "gl" #name,
+        GLTRACE_FUNCTIONS(GLTRACE_NAME)
+#undef GLTRACE_NAME
+        "FrameEnd"
+    };
+    size_t index = static_cast<size_t>(func);
+    return index < sizeof(names) / sizeof(names[0]) ? names[index] : "Unknown";
+}
+
+bool GLTraceBegin(const char* path)
+{
+    if (s_Recorder.recording)
+        return false;
+
+    s_Recorder.file.open(path, std::ios::binary | std::ios::trunc);
+    if (!s_Recorder.file)
+    {
+        std::cerr << "Failed to open GL trace file " << path << std::endl;
+        return false;
+    }
+
+    GLTraceHeader header = {{'G', 'L', 'T', 'R'}, GLTRACE_VERSION};
+    s_Recorder.file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    s_Recorder.start = Clock::now();
+    s_Recorder.recording = true;
+
+    // Entry points the driver didn't provide stay null.
+#define GLTRACE_HOOK(name) s_Real##name = glad_gl##name; if (s_Real##name) glad_gl##name = Trace##name;
+    GLTRACE_FUNCTIONS_CORE(GLTRACE_HOOK)
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+    GLTRACE_FUNCTIONS_BUFFER_STORAGE(GLTRACE_HOOK)
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+    GLTRACE_FUNCTIONS_ATTRIB_BINDING(GLTRACE_HOOK)
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+    GLTRACE_FUNCTIONS_MULTI_DRAW_INDIRECT(GLTRACE_HOOK)
+#endif
+#undef GLTRACE_HOOK
+    return true;
+}
+
+void GLTraceEnd()
+{
+    if (!s_Recorder.recording)
+        return;
+
+#define GLTRACE_UNHOOK(name) glad_gl##name = s_Real##name;
+    GLTRACE_FUNCTIONS_CORE(GLTRACE_UNHOOK)
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+    GLTRACE_FUNCTIONS_BUFFER_STORAGE(GLTRACE_UNHOOK)
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+    GLTRACE_FUNCTIONS_ATTRIB_BINDING(GLTRACE_UNHOOK)
+#endif
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+    GLTRACE_FUNCTIONS_MULTI_DRAW_INDIRECT(GLTRACE_UNHOOK)
+#endif
+#undef GLTRACE_UNHOOK
+
+    std::lock_guard<std::mutex> lock(s_Recorder.mutex);
+    FlushPending();
+    s_Recorder.file.close();
+    s_Recorder.recording = false;
+}
+
+bool GLTraceIsRecording()
+{
+    return s_Recorder.recording;
+}
+
+void GLTraceFrame()
+{
+    if (s_Recorder.recording)
+        Record frame(GLTraceFunc::FrameEnd);
+}
+
+GLTraceReplayer::GLTraceReplayer(bool nullBackend)
+    : m_NullBackend(nullBackend), m_NextFakeName(1), m_CurrentProgram(0)
+{
+}
+
+bool GLTraceReplayer::Load(const char* path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        std::cerr << "Failed to open GL trace file " << path << std::endl;
+        return false;
+    }
+    m_Data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+    GLTraceHeader header;
+    if (m_Data.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, m_Data.data(), sizeof(header));
+    if (std::memcmp(header.magic, "GLTR", 4) != 0 || header.version != GLTRACE_VERSION)
+    {
+        std::cerr << "Unsupported GL trace file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+unsigned int GLTraceReplayer::Map(const std::unordered_map<unsigned int, unsigned int>& names, unsigned int name) const
+{
+    auto it = names.find(name);
+    return it != names.end() ? it->second : 0;
+}
+
+int GLTraceReplayer::MapUniform(int location) const
+{
+    auto it = m_UniformLocations.find(((uint64_t)m_CurrentProgram << 32) | (uint32_t)location);
+    return it != m_UniformLocations.end() ? it->second : -1;
+}
+
+GLTraceReplayStats GLTraceReplayer::ReplayImpl(void (*onFrameEnd)(void*), void* user)
+{
+    using Clock = std::chrono::steady_clock;
+
+    GLTraceReplayStats stats;
+    const uint8_t* cursor = m_Data.data() + sizeof(GLTraceHeader);
+    const uint8_t* end = m_Data.data() + m_Data.size();
+
+    auto frameStart = Clock::now();
+    uint64_t recordedFrameStart = 0;
+    while (cursor + RECORD_HEADER_SIZE <= end)
+    {
+        uint16_t func;
+        uint32_t size;
+        uint64_t timestamp;
+        std::memcpy(&func, cursor, sizeof(func));
+        std::memcpy(&size, cursor + sizeof(func), sizeof(size));
+        std::memcpy(&timestamp, cursor + sizeof(func) + sizeof(size), sizeof(timestamp));
+        cursor += RECORD_HEADER_SIZE;
+        if (cursor + size > end || func >= (uint16_t)GLTraceFunc::Count)
+            break;
+
+        stats.commands++;
+        stats.callsPerFunc[func]++;
+        if ((GLTraceFunc)func == GLTraceFunc::FrameEnd)
+        {
+            auto now = Clock::now();
+            stats.frameMs.push_back(std::chrono::duration<double, std::milli>(now - frameStart).count());
+            stats.recordedFrameMs.push_back((timestamp - recordedFrameStart) / 1e6);
+            recordedFrameStart = timestamp;
+            onFrameEnd(user);
+            frameStart = Clock::now();
+        }
+        else
+        {
+            Execute((GLTraceFunc)func, cursor, size);
+        }
+        cursor += size;
+    }
+    return stats;
+}
+
+void GLTraceReplayer::Execute(GLTraceFunc func, const uint8_t* payload, uint32_t size)
+{
+    Reader in(payload, size);
+    uint64_t blobSize = 0;
+
+    // Creates replay names for a Gen* record and remembers the mapping.
+    auto genNames = [&](std::unordered_map<unsigned int, unsigned int>& names, void (APIENTRYP gen)(GLsizei, GLuint*)) {
+        const GLuint* traced = static_cast<const GLuint*>(in.Blob(blobSize));
+        GLsizei n = (GLsizei)(blobSize / sizeof(GLuint));
+        std::vector<GLuint> created(n);
+        if (m_NullBackend)
+            for (auto& name : created) name = m_NextFakeName++;
+        else if (n)
+            gen(n, created.data());
+        for (GLsizei i = 0; i < n; i++)
+            names[traced[i]] = created[i];
+    };
+    auto deleteNames = [&](std::unordered_map<unsigned int, unsigned int>& names, void (APIENTRYP del)(GLsizei, const GLuint*)) {
+        const GLuint* traced = static_cast<const GLuint*>(in.Blob(blobSize));
+        GLsizei n = (GLsizei)(blobSize / sizeof(GLuint));
+        std::vector<GLuint> mapped(n);
+        for (GLsizei i = 0; i < n; i++)
+        {
+            mapped[i] = Map(names, traced[i]);
+            names.erase(traced[i]);
+        }
+        if (!m_NullBackend && n)
+            del(n, mapped.data());
+    };
+
+    switch (func)
+    {
+        case GLTraceFunc::GenBuffers: genNames(m_Buffers, glGenBuffers); return;
+        case GLTraceFunc::DeleteBuffers: deleteNames(m_Buffers, glDeleteBuffers); return;
+        case GLTraceFunc::GenVertexArrays: genNames(m_VertexArrays, glGenVertexArrays); return;
+        case GLTraceFunc::DeleteVertexArrays: deleteNames(m_VertexArrays, glDeleteVertexArrays); return;
+        case GLTraceFunc::GenTextures: genNames(m_Textures, glGenTextures); return;
+        case GLTraceFunc::DeleteTextures: deleteNames(m_Textures, glDeleteTextures); return;
+        case GLTraceFunc::CreateShader:
+        {
+            GLenum type = in.Read<GLenum>();
+            GLuint traced = in.Read<GLuint>();
+            m_Shaders[traced] = m_NullBackend ? m_NextFakeName++ : glCreateShader(type);
+            return;
+        }
+        case GLTraceFunc::CreateProgram:
+        {
+            GLuint traced = in.Read<GLuint>();
+            m_Programs[traced] = m_NullBackend ? m_NextFakeName++ : glCreateProgram();
+            return;
+        }
+        case GLTraceFunc::GetUniformLocation:
+        {
+            GLuint program = in.Read<GLuint>();
+            GLint traced = in.Read<GLint>();
+            const char* name = static_cast<const char*>(in.Blob(blobSize));
+            std::string uniform(name ? name : "", blobSize);
+            GLint location = m_NullBackend ? traced : glGetUniformLocation(Map(m_Programs, program), uniform.c_str());
+            m_UniformLocations[((uint64_t)program << 32) | (uint32_t)traced] = location;
+            return;
+        }
+        case GLTraceFunc::GetUniformBlockIndex:
+        {
+            GLuint program = in.Read<GLuint>();
+            GLuint traced = in.Read<GLuint>();
+            const char* name = static_cast<const char*>(in.Blob(blobSize));
+            std::string block(name ? name : "", blobSize);
+            GLuint index = m_NullBackend ? traced : glGetUniformBlockIndex(Map(m_Programs, program), block.c_str());
+            m_UniformBlocks[((uint64_t)program << 32) | traced] = index;
+            return;
+        }
+        case GLTraceFunc::UseProgram:
+            m_CurrentProgram = in.Read<GLuint>();
+            if (!m_NullBackend)
+                glUseProgram(Map(m_Programs, m_CurrentProgram));
+            return;
+        default:
+            break;
+    }
+
+    if (m_NullBackend)
+        return;
+
+    switch (func)
+    {
+        case GLTraceFunc::BindBuffer:
+        {
+            GLenum target = in.Read<GLenum>();
+            glBindBuffer(target, Map(m_Buffers, in.Read<GLuint>()));
+            break;
+        }
+        case GLTraceFunc::BufferData:
+        {
+            GLenum target = in.Read<GLenum>();
+            GLenum usage = in.Read<GLenum>();
+            int64_t bytes = in.Read<int64_t>();
+            const void* data = in.Blob(blobSize);
+            glBufferData(target, (GLsizeiptr)bytes, data, usage);
+            break;
+        }
+        case GLTraceFunc::BufferSubData:
+        {
+            GLenum target = in.Read<GLenum>();
+            int64_t offset = in.Read<int64_t>();
+            const void* data = in.Blob(blobSize);
+            glBufferSubData(target, (GLintptr)offset, (GLsizeiptr)blobSize, data);
+            break;
+        }
+        case GLTraceFunc::BufferStorage:
+        {
+            GLenum target = in.Read<GLenum>();
+            GLbitfield flags = in.Read<GLbitfield>();
+            int64_t bytes = in.Read<int64_t>();
+            const void* data = in.Blob(blobSize);
+            // Without 4.4 mutable storage does; nothing persistent was traced.
+#if defined(GL_VERSION_4_4) || defined(GL_ARB_buffer_storage)
+            if (glBufferStorage)
+            {
+                glBufferStorage(target, (GLsizeiptr)bytes, data, flags);
+                break;
+            }
+#endif
+            (void)flags;
+            glBufferData(target, (GLsizeiptr)bytes, data, GL_DYNAMIC_DRAW);
+            break;
+        }
+        case GLTraceFunc::MapBufferRange:
+        {
+            GLenum target = in.Read<GLenum>();
+            GLbitfield access = in.Read<GLbitfield>();
+            int64_t offset = in.Read<int64_t>();
+            int64_t length = in.Read<int64_t>();
+            m_Mappings[target] = glMapBufferRange(target, (GLintptr)offset, (GLsizeiptr)length, access);
+            break;
+        }
+        case GLTraceFunc::FlushMappedBufferRange:
+        {
+            GLenum target = in.Read<GLenum>();
+            int64_t offset = in.Read<int64_t>();
+            const void* data = in.Blob(blobSize);
+            auto it = m_Mappings.find(target);
+            if (it != m_Mappings.end() && it->second && data)
+                std::memcpy(static_cast<uint8_t*>(it->second) + offset, data, blobSize);
+            glFlushMappedBufferRange(target, (GLintptr)offset, (GLsizeiptr)blobSize);
+            break;
+        }
+        case GLTraceFunc::UnmapBuffer:
+        {
+            GLenum target = in.Read<GLenum>();
+            const void* data = in.Blob(blobSize);
+            auto it = m_Mappings.find(target);
+            if (it != m_Mappings.end())
+            {
+                if (it->second && data)
+                    std::memcpy(it->second, data, blobSize);
+                m_Mappings.erase(it);
+            }
+            glUnmapBuffer(target);
+            break;
+        }
+        case GLTraceFunc::FenceSync:
+        {
+            GLenum condition = in.Read<GLenum>();
+            GLbitfield flags = in.Read<GLbitfield>();
+            m_Syncs[in.Read<uint64_t>()] = glFenceSync(condition, flags);
+            break;
+        }
+        case GLTraceFunc::ClientWaitSync:
+        {
+            auto it = m_Syncs.find(in.Read<uint64_t>());
+            GLbitfield flags = in.Read<GLbitfield>();
+            GLuint64 timeout = in.Read<uint64_t>();
+            if (it != m_Syncs.end())
+                glClientWaitSync(it->second, flags, timeout);
+            break;
+        }
+        case GLTraceFunc::DeleteSync:
+        {
+            auto it = m_Syncs.find(in.Read<uint64_t>());
+            if (it != m_Syncs.end())
+            {
+                glDeleteSync(it->second);
+                m_Syncs.erase(it);
+            }
+            break;
+        }
+        case GLTraceFunc::BindVertexArray:
+            glBindVertexArray(Map(m_VertexArrays, in.Read<GLuint>()));
+            break;
+        case GLTraceFunc::EnableVertexAttribArray:
+            glEnableVertexAttribArray(in.Read<GLuint>());
+            break;
+        case GLTraceFunc::VertexAttribPointer:
+        {
+            GLuint index = in.Read<GLuint>();
+            GLint count = in.Read<GLint>();
+            GLenum type = in.Read<GLenum>();
+            GLboolean normalized = in.Read<GLboolean>();
+            GLsizei stride = in.Read<GLsizei>();
+            uint64_t offset = in.Read<uint64_t>();
+            glVertexAttribPointer(index, count, type, normalized, stride, (const void*)(uintptr_t)offset);
+            break;
+        }
+        case GLTraceFunc::VertexAttribDivisor:
+        {
+            GLuint index = in.Read<GLuint>();
+            glVertexAttribDivisor(index, in.Read<GLuint>());
+            break;
+        }
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_vertex_attrib_binding)
+        // Only ever recorded where the loader provided them.
+        case GLTraceFunc::VertexAttribFormat:
+        {
+            GLuint index = in.Read<GLuint>();
+            GLint count = in.Read<GLint>();
+            GLenum type = in.Read<GLenum>();
+            GLboolean normalized = in.Read<GLboolean>();
+            glVertexAttribFormat(index, count, type, normalized, in.Read<GLuint>());
+            break;
+        }
+        case GLTraceFunc::BindVertexBuffer:
+        {
+            GLuint binding = in.Read<GLuint>();
+            GLuint buffer = Map(m_Buffers, in.Read<GLuint>());
+            int64_t offset = in.Read<int64_t>();
+            glBindVertexBuffer(binding, buffer, (GLintptr)offset, in.Read<GLsizei>());
+            break;
+        }
+        case GLTraceFunc::VertexAttribBinding:
+        {
+            GLuint index = in.Read<GLuint>();
+            glVertexAttribBinding(index, in.Read<GLuint>());
+            break;
+        }
+#endif
+        case GLTraceFunc::ShaderSource:
+        {
+            GLuint shader = Map(m_Shaders, in.Read<GLuint>());
+            const GLchar* source = static_cast<const GLchar*>(in.Blob(blobSize));
+            GLint length = (GLint)blobSize;
+            glShaderSource(shader, 1, &source, &length);
+            break;
+        }
+        case GLTraceFunc::CompileShader:
+            glCompileShader(Map(m_Shaders, in.Read<GLuint>()));
+            break;
+        case GLTraceFunc::DeleteShader:
+        {
+            GLuint traced = in.Read<GLuint>();
+            glDeleteShader(Map(m_Shaders, traced));
+            m_Shaders.erase(traced);
+            break;
+        }
+        case GLTraceFunc::AttachShader:
+        {
+            GLuint program = Map(m_Programs, in.Read<GLuint>());
+            glAttachShader(program, Map(m_Shaders, in.Read<GLuint>()));
+            break;
+        }
+        case GLTraceFunc::LinkProgram:
+            glLinkProgram(Map(m_Programs, in.Read<GLuint>()));
+            break;
+        case GLTraceFunc::ValidateProgram:
+            glValidateProgram(Map(m_Programs, in.Read<GLuint>()));
+            break;
+        case GLTraceFunc::DeleteProgram:
+        {
+            GLuint traced = in.Read<GLuint>();
+            glDeleteProgram(Map(m_Programs, traced));
+            m_Programs.erase(traced);
+            break;
+        }
+        case GLTraceFunc::Uniform1i:
+        {
+            GLint location = MapUniform(in.Read<GLint>());
+            glUniform1i(location, in.Read<GLint>());
+            break;
+        }
+        case GLTraceFunc::Uniform1f:
+        {
+            GLint location = MapUniform(in.Read<GLint>());
+            glUniform1f(location, in.Read<GLfloat>());
+            break;
+        }
+        case GLTraceFunc::Uniform2f:
+        {
+            GLint location = MapUniform(in.Read<GLint>());
+            GLfloat v[2];
+            for (auto& value : v) value = in.Read<GLfloat>();
+            glUniform2f(location, v[0], v[1]);
+            break;
+        }
+        case GLTraceFunc::Uniform3f:
+        {
+            GLint location = MapUniform(in.Read<GLint>());
+            GLfloat v[3];
+            for (auto& value : v) value = in.Read<GLfloat>();
+            glUniform3f(location, v[0], v[1], v[2]);
+            break;
+        }
+        case GLTraceFunc::Uniform4f:
+        {
+            GLint location = MapUniform(in.Read<GLint>());
+            GLfloat v[4];
+            for (auto& value : v) value = in.Read<GLfloat>();
+            glUniform4f(location, v[0], v[1], v[2], v[3]);
+            break;
+        }
+        case GLTraceFunc::Uniform4fv:
+        {
+            GLint location = MapUniform(in.Read<GLint>());
+            const GLfloat* value = static_cast<const GLfloat*>(in.Blob(blobSize));
+            if (value)
+                glUniform4fv(location, (GLsizei)(blobSize / (4 * sizeof(GLfloat))), value);
+            break;
+        }
+        case GLTraceFunc::UniformBlockBinding:
+        {
+            GLuint program = in.Read<GLuint>();
+            auto it = m_UniformBlocks.find(((uint64_t)program << 32) | in.Read<GLuint>());
+            GLuint binding = in.Read<GLuint>();
+            if (it != m_UniformBlocks.end())
+                glUniformBlockBinding(Map(m_Programs, program), it->second, binding);
+            break;
+        }
+        case GLTraceFunc::BindBufferRange:
+        {
+            GLenum target = in.Read<GLenum>();
+            GLuint index = in.Read<GLuint>();
+            GLuint buffer = Map(m_Buffers, in.Read<GLuint>());
+            int64_t offset = in.Read<int64_t>();
+            glBindBufferRange(target, index, buffer, (GLintptr)offset, (GLsizeiptr)in.Read<int64_t>());
+            break;
+        }
+        case GLTraceFunc::UniformMatrix4fv:
+        {
+            GLint location = MapUniform(in.Read<GLint>());
+            GLboolean transpose = in.Read<GLboolean>();
+            const GLfloat* value = static_cast<const GLfloat*>(in.Blob(blobSize));
+            if (value)
+                glUniformMatrix4fv(location, (GLsizei)(blobSize / (16 * sizeof(GLfloat))), transpose, value);
+            break;
+        }
+        case GLTraceFunc::ActiveTexture:
+            glActiveTexture(in.Read<GLenum>());
+            break;
+        case GLTraceFunc::BindTexture:
+        {
+            GLenum target = in.Read<GLenum>();
+            glBindTexture(target, Map(m_Textures, in.Read<GLuint>()));
+            break;
+        }
+        case GLTraceFunc::TexParameteri:
+        {
+            GLenum target = in.Read<GLenum>();
+            GLenum pname = in.Read<GLenum>();
+            glTexParameteri(target, pname, in.Read<GLint>());
+            break;
+        }
+        case GLTraceFunc::TexImage2D:
+        {
+            GLenum target = in.Read<GLenum>();
+            GLint level = in.Read<GLint>();
+            GLint internalformat = in.Read<GLint>();
+            GLsizei width = in.Read<GLsizei>();
+            GLsizei height = in.Read<GLsizei>();
+            GLint border = in.Read<GLint>();
+            GLenum format = in.Read<GLenum>();
+            GLenum type = in.Read<GLenum>();
+            const void* pixels = in.Blob(blobSize);
+            glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+            break;
+        }
+        case GLTraceFunc::GenerateMipmap:
+            glGenerateMipmap(in.Read<GLenum>());
+            break;
+        case GLTraceFunc::Clear:
+            glClear(in.Read<GLbitfield>());
+            break;
+        case GLTraceFunc::ClearColor:
+        {
+            GLfloat c[4];
+            for (auto& value : c) value = in.Read<GLfloat>();
+            glClearColor(c[0], c[1], c[2], c[3]);
+            break;
+        }
+        case GLTraceFunc::Viewport:
+        {
+            GLint x = in.Read<GLint>();
+            GLint y = in.Read<GLint>();
+            GLsizei width = in.Read<GLsizei>();
+            glViewport(x, y, width, in.Read<GLsizei>());
+            break;
+        }
+        case GLTraceFunc::DrawElements:
+        {
+            GLenum mode = in.Read<GLenum>();
+            GLsizei count = in.Read<GLsizei>();
+            GLenum type = in.Read<GLenum>();
+            uint64_t offset = in.Read<uint64_t>();
+            glDrawElements(mode, count, type, (const void*)(uintptr_t)offset);
+            break;
+        }
+        case GLTraceFunc::DrawArrays:
+        {
+            GLenum mode = in.Read<GLenum>();
+            GLint first = in.Read<GLint>();
+            glDrawArrays(mode, first, in.Read<GLsizei>());
+            break;
+        }
+        case GLTraceFunc::DrawElementsInstanced:
+        {
+            GLenum mode = in.Read<GLenum>();
+            GLsizei count = in.Read<GLsizei>();
+            GLenum type = in.Read<GLenum>();
+            uint64_t offset = in.Read<uint64_t>();
+            glDrawElementsInstanced(mode, count, type, (const void*)(uintptr_t)offset, in.Read<GLsizei>());
+            break;
+        }
+        case GLTraceFunc::DrawElementsBaseVertex:
+        {
+            GLenum mode = in.Read<GLenum>();
+            GLsizei count = in.Read<GLsizei>();
+            GLenum type = in.Read<GLenum>();
+            uint64_t offset = in.Read<uint64_t>();
+            glDrawElementsBaseVertex(mode, count, type, (const void*)(uintptr_t)offset, in.Read<GLint>());
+            break;
+        }
+        case GLTraceFunc::DrawElementsInstancedBaseVertex:
+        {
+            GLenum mode = in.Read<GLenum>();
+            GLsizei count = in.Read<GLsizei>();
+            GLenum type = in.Read<GLenum>();
+            uint64_t offset = in.Read<uint64_t>();
+            GLsizei instances = in.Read<GLsizei>();
+            glDrawElementsInstancedBaseVertex(mode, count, type, (const void*)(uintptr_t)offset, instances, in.Read<GLint>());
+            break;
+        }
+#if defined(GL_VERSION_4_3) || defined(GL_ARB_multi_draw_indirect)
+        case GLTraceFunc::MultiDrawElementsIndirect:
+        {
+            GLenum mode = in.Read<GLenum>();
+            GLenum type = in.Read<GLenum>();
+            uint64_t offset = in.Read<uint64_t>();
+            GLsizei drawCount = in.Read<GLsizei>();
+            glMultiDrawElementsIndirect(mode, type, (const void*)(uintptr_t)offset, drawCount, in.Read<GLsizei>());
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+}
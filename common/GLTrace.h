@@ -0,0 +1,131 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Binary GL command trace.
+//
+// GLTraceBegin swaps the glad function pointers of every call listed in
+// GLTRACE_FUNCTIONS for recording thunks, so everything issued through
+// GLCall (and the few unwrapped calls such as glCreateShader) lands in the
+// trace with its arguments, the bytes of any buffer/texture/shader source it
+// references, and a timestamp. GLTraceEnd restores the original pointers.
+//
+// Mapped writes are captured when the range is flushed or unmapped. Persistent
+// mappings can't be observed, so buffers that want one should fall back to
+// map/unmap while GLTraceIsRecording().
+//
+// File layout (little endian):
+//   GLTraceHeader
+//   { uint16 function, uint32 payload size, uint64 ns since begin, payload }*
+#define GLTRACE_FUNCTIONS_CORE(X) \
+    X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BufferData) X(BufferSubData) \
+    X(MapBufferRange) X(FlushMappedBufferRange) X(UnmapBuffer) \
+    X(FenceSync) X(ClientWaitSync) X(DeleteSync) \
+    X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray) \
+    X(EnableVertexAttribArray) X(VertexAttribPointer) X(VertexAttribDivisor) \
+    X(CreateShader) X(ShaderSource) X(CompileShader) X(DeleteShader) \
+    X(CreateProgram) X(AttachShader) X(LinkProgram) X(ValidateProgram) \
+    X(UseProgram) X(DeleteProgram) X(GetUniformLocation) \
+    X(Uniform1i) X(Uniform1f) X(Uniform2f) X(Uniform3f) X(Uniform4f) X(Uniform4fv) X(UniformMatrix4fv) \
+    X(GetUniformBlockIndex) X(UniformBlockBinding) X(BindBufferRange) \
+    X(GenTextures) X(DeleteTextures) X(ActiveTexture) X(BindTexture) \
+    X(TexParameteri) X(TexImage2D) X(GenerateMipmap) \
+    X(Clear) X(ClearColor) X(Viewport) X(DrawElements) X(DrawArrays) \
+    X(DrawElementsInstanced) X(DrawElementsBaseVertex) X(DrawElementsInstancedBaseVertex)
+
+// Entry points newer than GL 3.3. They keep their ids in every build but are
+// only hooked where the loader was generated with them and has loaded them.
+#define GLTRACE_FUNCTIONS_BUFFER_STORAGE(X) X(BufferStorage)
+#define GLTRACE_FUNCTIONS_ATTRIB_BINDING(X) X(VertexAttribFormat) X(BindVertexBuffer) X(VertexAttribBinding)
+#define GLTRACE_FUNCTIONS_MULTI_DRAW_INDIRECT(X) X(MultiDrawElementsIndirect)
+#define GLTRACE_FUNCTIONS_OPTIONAL(X) \
+    GLTRACE_FUNCTIONS_BUFFER_STORAGE(X) GLTRACE_FUNCTIONS_ATTRIB_BINDING(X) GLTRACE_FUNCTIONS_MULTI_DRAW_INDIRECT(X)
+
+#define GLTRACE_FUNCTIONS(X) GLTRACE_FUNCTIONS_CORE(X) GLTRACE_FUNCTIONS_OPTIONAL(X)
+
+enum class GLTraceFunc : uint16_t
+{
+#define GLTRACE_ENUM(name) name,
+    GLTRACE_FUNCTIONS(GLTRACE_ENUM)
+#undef GLTRACE_ENUM
+    FrameEnd,
+    Count
+};
+
+const char* GLTraceFuncName(GLTraceFunc func);
+
+struct GLTraceHeader
+{
+    char magic[4];
+    uint32_t version;
+};
+
+constexpr uint32_t GLTRACE_VERSION = 8;
+
+// Starts recording into path. Call after gladLoadGLLoader.
+bool GLTraceBegin(const char* path);
+void GLTraceEnd();
+bool GLTraceIsRecording();
+// Marks the end of a frame; call right before swapping buffers.
+void GLTraceFrame();
+
+struct GLTraceReplayStats
+{
+    uint64_t commands = 0;
+    std::vector<double> frameMs;         // replay CPU time per frame
+    std::vector<double> recordedFrameMs; // frame time at capture
+    uint64_t callsPerFunc[(size_t)GLTraceFunc::Count] = {};
+};
+
+// Re-executes a trace. With nullBackend set no GL call is made, which
+// isolates decode cost from driver cost; object names are then synthesised.
+class GLTraceReplayer
+{
+    private:
+        std::vector<uint8_t> m_Data;
+        bool m_NullBackend;
+        unsigned int m_NextFakeName;
+
+        std::unordered_map<unsigned int, unsigned int> m_Buffers;
+        std::unordered_map<unsigned int, unsigned int> m_VertexArrays;
+        std::unordered_map<unsigned int, unsigned int> m_Textures;
+        std::unordered_map<unsigned int, unsigned int> m_Shaders;
+        std::unordered_map<unsigned int, unsigned int> m_Programs;
+        std::unordered_map<uint64_t, GLsync> m_Syncs;
+        // target -> pointer of the open mapping
+        std::unordered_map<GLenum, void*> m_Mappings;
+        // (trace program << 32 | trace location) -> replay location
+        std::unordered_map<uint64_t, int> m_UniformLocations;
+        // (trace program << 32 | trace block index) -> replay block index
+        std::unordered_map<uint64_t, unsigned int> m_UniformBlocks;
+        unsigned int m_CurrentProgram;
+
+        unsigned int Map(const std::unordered_map<unsigned int, unsigned int>& names, unsigned int name) const;
+        int MapUniform(int location) const;
+        void Execute(GLTraceFunc func, const uint8_t* payload, uint32_t size);
+
+    public:
+        explicit GLTraceReplayer(bool nullBackend = false);
+
+        bool Load(const char* path);
+
+        // Replays every frame; onFrameEnd runs after each FrameEnd record
+        // (e.g. to swap or glFinish) and is excluded from the frame time.
+        template<typename F>
+        GLTraceReplayStats Replay(F&& onFrameEnd);
+        GLTraceReplayStats Replay() { return Replay([]{}); }
+
+    private:
+        GLTraceReplayStats ReplayImpl(void (*onFrameEnd)(void*), void* user);
+};
+
+template<typename F>
+GLTraceReplayStats GLTraceReplayer::Replay(F&& onFrameEnd)
+{
+    return ReplayImpl([](void* user) { (*static_cast<std::remove_reference_t<F>*>(user))(); }, (void*)&onFrameEnd);
+}
@@ -0,0 +1,178 @@
+#include "GpuProfiler.h"
+#include "GLDebug.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+    double Percentile(std::vector<double> values, double quantile)
+    {
+        if (values.empty())
+            return 0.0;
+        size_t index = std::min(values.size() - 1, (size_t)(quantile * (values.size() - 1) + 0.5));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    void PrintRow(std::ostream& out, const char* label, const std::vector<double>& samples)
+    {
+        if (samples.empty())
+        {
+            out << std::setw(8) << label << "  n/a\n";
+            return;
+        }
+        out << std::setw(8) << label
+            << std::setw(10) << Percentile(samples, 0.50)
+            << std::setw(10) << Percentile(samples, 0.95)
+            << std::setw(10) << Percentile(samples, 0.99)
+            << std::setw(10) << *std::max_element(samples.begin(), samples.end()) << "\n";
+    }
+}
+
+GpuProfiler::GpuProfiler(unsigned int framesInFlight, unsigned int maxZonesPerFrame)
+    : m_Frames(std::max(1u, framesInFlight)), m_FrameIndex(0), m_MaxZones(maxZonesPerFrame),
+      m_TimerQueries(false), m_DroppedFrames(0), m_LastFrameGpuMs(-1.0)
+{
+    GLint bits = 0;
+    GLCall(glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits));
+    m_TimerQueries = bits > 0;
+    if (!m_TimerQueries)
+        return;
+
+    for (Frame& frame : m_Frames)
+    {
+        frame.queries.resize(m_MaxZones * 2);
+        GLCall(glGenQueries((GLsizei)frame.queries.size(), frame.queries.data()));
+        frame.zones.reserve(m_MaxZones);
+    }
+}
+
+GpuProfiler::~GpuProfiler()
+{
+    for (Frame& frame : m_Frames)
+        if (!frame.queries.empty())
+            GLCall(glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data()));
+}
+
+GpuProfiler::Samples& GpuProfiler::SamplesFor(const char* name)
+{
+    auto it = m_Samples.find(name);
+    if (it == m_Samples.end())
+    {
+        m_Order.push_back(name);
+        it = m_Samples.emplace(name, Samples()).first;
+    }
+    return it->second;
+}
+
+void GpuProfiler::Collect(Frame& frame)
+{
+    if (!frame.pending)
+        return;
+    frame.pending = false;
+
+    if (m_TimerQueries && frame.lastEndQuery)
+    {
+        // The last end query completes last; if it is not ready, none of the
+        // frame is worth waiting for. With nesting that is the outermost
+        // zone's, not the last zone begun.
+        GLuint available = GL_FALSE;
+        GLCall(glGetQueryObjectuiv(frame.lastEndQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+        if (!available)
+        {
+            m_DroppedFrames++;
+            return;
+        }
+    }
+
+    double frameGpuMs = 0.0;
+    for (const Zone& zone : frame.zones)
+    {
+        Samples& samples = SamplesFor(zone.name);
+        samples.cpuMs.push_back(zone.cpuMs);
+        if (!m_TimerQueries || zone.beginQuery == 0)
+            continue;
+
+        GLuint64 begin = 0, end = 0;
+        GLCall(glGetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &begin));
+        GLCall(glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end));
+        double ms = (end - begin) / 1e6;
+        samples.gpuMs.push_back(ms);
+        // Nested zones are already inside their parent's time.
+        if (zone.depth == 0)
+            frameGpuMs += ms;
+    }
+    if (m_TimerQueries)
+        m_LastFrameGpuMs = frameGpuMs;
+}
+
+void GpuProfiler::BeginFrame()
+{
+    Frame& frame = m_Frames[m_FrameIndex];
+    m_LastFrameGpuMs = -1.0;
+    Collect(frame);
+    frame.zones.clear();
+    frame.depth = 0;
+    frame.lastEndQuery = 0;
+}
+
+void GpuProfiler::EndFrame()
+{
+    m_Frames[m_FrameIndex].pending = true;
+    m_FrameIndex = (m_FrameIndex + 1) % m_Frames.size();
+}
+
+int GpuProfiler::BeginZone(const char* name)
+{
+    Frame& frame = m_Frames[m_FrameIndex];
+    Zone zone = {name, 0, 0, 0.0, frame.depth++};
+    // Zones past the per-frame budget still get CPU timing.
+    if (m_TimerQueries && frame.zones.size() < m_MaxZones)
+    {
+        zone.beginQuery = frame.queries[frame.zones.size() * 2];
+        zone.endQuery = frame.queries[frame.zones.size() * 2 + 1];
+        GLCall(glQueryCounter(zone.beginQuery, GL_TIMESTAMP));
+    }
+    frame.zones.push_back(zone);
+    return (int)frame.zones.size() - 1;
+}
+
+void GpuProfiler::EndZone(int zone, double cpuMs)
+{
+    Frame& frame = m_Frames[m_FrameIndex];
+    Zone& entry = frame.zones[zone];
+    // Zones end in reverse order of BeginZone, as GpuZone scopes do.
+    ASSERT(frame.depth == entry.depth + 1);
+    frame.depth = entry.depth;
+    entry.cpuMs = cpuMs;
+    if (entry.endQuery)
+    {
+        GLCall(glQueryCounter(entry.endQuery, GL_TIMESTAMP));
+        frame.lastEndQuery = entry.endQuery;
+    }
+}
+
+void GpuProfiler::Reset()
+{
+    m_Samples.clear();
+    m_Order.clear();
+    m_DroppedFrames = 0;
+}
+
+void GpuProfiler::Report(std::ostream& out) const
+{
+    out << "Zone timings (ms)" << (m_TimerQueries ? "" : ", timer queries unavailable: CPU only") << "\n";
+    for (const std::string& name : m_Order)
+    {
+        const Samples& samples = m_Samples.at(name);
+        out << name << " (" << samples.cpuMs.size() << " frames)\n";
+        out << std::setw(8) << "" << std::setw(10) << "p50" << std::setw(10) << "p95"
+            << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+        if (m_TimerQueries)
+            PrintRow(out, "gpu", samples.gpuMs);
+        PrintRow(out, "cpu", samples.cpuMs);
+    }
+    if (m_DroppedFrames)
+        out << m_DroppedFrames << " frames dropped (queries not ready after " << m_Frames.size() << " frames)\n";
+    out.flush();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Scoped GPU/CPU zone profiler.
+//
+// Each zone brackets its GL work with two GL_TIMESTAMP queries taken from a
+// ring of pre-allocated query objects, one set per frame in flight. Results
+// are read back framesInFlight frames later and only if the driver already
+// has them, so profiling never stalls the pipeline; a frame whose queries are
+// still pending is dropped instead. On contexts without timer queries
+// (GL_QUERY_COUNTER_BITS == 0) only CPU time is recorded.
+//
+// Zones may nest; an inner zone is reported on its own and is also part of
+// its parent's time.
+//
+//     profiler.BeginFrame();
+//     { GpuZone zone(profiler, "draw"); ... }
+//     profiler.EndFrame();
+class GpuProfiler
+{
+    private:
+        struct Zone
+        {
+            const char* name;
+            unsigned int beginQuery;
+            unsigned int endQuery;
+            double cpuMs;
+            unsigned int depth;
+        };
+
+        struct Frame
+        {
+            std::vector<unsigned int> queries;
+            std::vector<Zone> zones;
+            // Zones begun but not yet ended.
+            unsigned int depth = 0;
+            // Issued after every other query of the frame.
+            unsigned int lastEndQuery = 0;
+            bool pending = false;
+        };
+
+        struct Samples
+        {
+            std::vector<double> gpuMs;
+            std::vector<double> cpuMs;
+        };
+
+        std::vector<Frame> m_Frames;
+        unsigned int m_FrameIndex;
+        unsigned int m_MaxZones;
+        bool m_TimerQueries;
+        unsigned long long m_DroppedFrames;
+        double m_LastFrameGpuMs;
+        std::unordered_map<std::string, Samples> m_Samples;
+        std::vector<std::string> m_Order;
+
+        void Collect(Frame& frame);
+        Samples& SamplesFor(const char* name);
+
+    public:
+        GpuProfiler(unsigned int framesInFlight = 4, unsigned int maxZonesPerFrame = 32);
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        void BeginFrame();
+        void EndFrame();
+
+        // Returns a zone index for EndZone. name must outlive the profiler.
+        int BeginZone(const char* name);
+        void EndZone(int zone, double cpuMs);
+
+        // Drops every sample collected so far, e.g. after warmup frames.
+        void Reset();
+
+        // Per-zone GPU and CPU p50/p95/p99/max in milliseconds.
+        void Report(std::ostream& out) const;
+
+        inline bool HasTimerQueries() const { return m_TimerQueries; }
+        // Sum of the top-level zones of the frame resolved by the latest
+        // BeginFrame, or a negative value when that call resolved nothing.
+        inline double GetLastFrameGpuMs() const { return m_LastFrameGpuMs; }
+};
+
+class GpuZone
+{
+    private:
+        GpuProfiler& m_Profiler;
+        int m_Zone;
+        std::chrono::steady_clock::time_point m_Start;
+
+    public:
+        GpuZone(GpuProfiler& profiler, const char* name)
+            : m_Profiler(profiler), m_Zone(profiler.BeginZone(name)), m_Start(std::chrono::steady_clock::now()) {}
+        ~GpuZone()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - m_Start;
+            m_Profiler.EndZone(m_Zone, std::chrono::duration<double, std::milli>(elapsed).count());
+        }
+
+        GpuZone(const GpuZone&) = delete;
+        GpuZone& operator=(const GpuZone&) = delete;
+};
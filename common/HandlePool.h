@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// 32-bit generational handle: the low INDEX_BITS pick a slot, the rest count
+// how often that slot was reused, so a handle to a destroyed object stays
+// invalid after its slot is recycled. The zero handle is never valid.
+template<typename T>
+struct Handle
+{
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+    uint32_t value = 0;
+
+    inline uint32_t GetIndex() const { return value & INDEX_MASK; }
+    inline uint32_t GetGeneration() const { return value >> INDEX_BITS; }
+    inline bool IsValid() const { return value != 0; }
+
+    bool operator==(Handle other) const { return value == other.value; }
+    bool operator!=(Handle other) const { return value != other.value; }
+};
+
+// Objects stored densely in one vector and addressed through handles.
+//
+// Destroy moves the last object into the hole, so iterating the pool walks
+// contiguous memory no matter how objects were created and destroyed; T only
+// needs to be move constructible and move assignable. Pointers returned by
+// Get are invalidated by any Create or Destroy, handles are not.
+template<typename T>
+class HandlePool
+{
+    private:
+        static constexpr uint32_t NONE = ~0u;
+
+        struct Slot
+        {
+            uint32_t dense;      // index into m_Objects, or next free slot
+            uint32_t generation;
+        };
+
+        std::vector<T> m_Objects;
+        std::vector<uint32_t> m_DenseToSlot;
+        std::vector<Slot> m_Slots;
+        uint32_t m_FreeHead = NONE;
+
+        const Slot* Find(Handle<T> handle) const
+        {
+            uint32_t index = handle.GetIndex();
+            if (!handle.IsValid() || index >= m_Slots.size())
+                return nullptr;
+            const Slot& slot = m_Slots[index];
+            if (slot.generation != handle.GetGeneration())
+                return nullptr;
+            return &slot;
+        }
+
+    public:
+        template<typename... Args>
+        Handle<T> Create(Args&&... args)
+        {
+            uint32_t index;
+            if (m_FreeHead != NONE)
+            {
+                index = m_FreeHead;
+                m_FreeHead = m_Slots[index].dense;
+            }
+            else
+            {
+                index = (uint32_t)m_Slots.size();
+                if (index > Handle<T>::INDEX_MASK)
+                    return Handle<T>();
+                m_Slots.push_back({NONE, 1});
+            }
+
+            m_Objects.emplace_back(std::forward<Args>(args)...);
+            m_DenseToSlot.push_back(index);
+            m_Slots[index].dense = (uint32_t)m_Objects.size() - 1;
+
+            Handle<T> handle;
+            handle.value = (m_Slots[index].generation << Handle<T>::INDEX_BITS) | index;
+            return handle;
+        }
+
+        void Destroy(Handle<T> handle)
+        {
+            const Slot* found = Find(handle);
+            if (!found)
+                return;
+            uint32_t index = handle.GetIndex();
+            uint32_t dense = found->dense;
+            uint32_t last = (uint32_t)m_Objects.size() - 1;
+            if (dense != last)
+            {
+                m_Objects[dense] = std::move(m_Objects[last]);
+                m_DenseToSlot[dense] = m_DenseToSlot[last];
+                m_Slots[m_DenseToSlot[dense]].dense = dense;
+            }
+            m_Objects.pop_back();
+            m_DenseToSlot.pop_back();
+
+            Slot& slot = m_Slots[index];
+            // Generation 0 would let a stale handle equal the zero handle.
+            slot.generation = (slot.generation + 1) & Handle<T>::GENERATION_MASK;
+            if (slot.generation == 0)
+                slot.generation = 1;
+            slot.dense = m_FreeHead;
+            m_FreeHead = index;
+        }
+
+        T* Get(Handle<T> handle)
+        {
+            const Slot* slot = Find(handle);
+            return slot ? &m_Objects[slot->dense] : nullptr;
+        }
+        const T* Get(Handle<T> handle) const
+        {
+            const Slot* slot = Find(handle);
+            return slot ? &m_Objects[slot->dense] : nullptr;
+        }
+        inline bool IsAlive(Handle<T> handle) const { return Find(handle) != nullptr; }
+
+        void Reserve(uint32_t count)
+        {
+            m_Objects.reserve(count);
+            m_DenseToSlot.reserve(count);
+            m_Slots.reserve(count);
+        }
+
+        inline uint32_t GetSize() const { return (uint32_t)m_Objects.size(); }
+
+        // Dense iteration in storage order.
+        inline typename std::vector<T>::iterator begin() { return m_Objects.begin(); }
+        inline typename std::vector<T>::iterator end() { return m_Objects.end(); }
+        inline typename std::vector<T>::const_iterator begin() const { return m_Objects.begin(); }
+        inline typename std::vector<T>::const_iterator end() const { return m_Objects.end(); }
+};
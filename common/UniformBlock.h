@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+// Member types for uniform block structs. Their C++ alignment matches the
+// std140 base alignment, so most blocks lay out correctly as declared.
+// Std140Vec3 is the exception: std140 lets a scalar follow it at offset 12,
+// C++ can't; UNIFORM_BLOCK rejects that, so put a Std140Vec3 last in its
+// 16 bytes or use a Std140Vec4. bool is 4 bytes in GLSL; use int.
+struct alignas(8) Std140Vec2 { float x, y; };
+struct alignas(16) Std140Vec3 { float x, y, z; };
+struct alignas(16) Std140Vec4 { float x, y, z, w; };
+// Column major, one Std140Vec4 per column.
+struct alignas(16) Std140Mat4 { Std140Vec4 columns[4]; };
+
+// std140 base alignment and size of a member type. Types without a
+// specialization can't be used in a UNIFORM_BLOCK.
+template<typename T>
+struct Std140Traits;
+
+template<unsigned int Alignment, unsigned int Size>
+struct Std140TraitsBase
+{
+    static constexpr unsigned int alignment = Alignment;
+    static constexpr unsigned int size = Size;
+};
+
+template<> struct Std140Traits<float> : Std140TraitsBase<4, 4> {};
+template<> struct Std140Traits<int> : Std140TraitsBase<4, 4> {};
+template<> struct Std140Traits<unsigned int> : Std140TraitsBase<4, 4> {};
+template<> struct Std140Traits<Std140Vec2> : Std140TraitsBase<8, 8> {};
+template<> struct Std140Traits<Std140Vec3> : Std140TraitsBase<16, 12> {};
+template<> struct Std140Traits<Std140Vec4> : Std140TraitsBase<16, 16> {};
+template<> struct Std140Traits<Std140Mat4> : Std140TraitsBase<16, 64> {};
+
+// Array elements are padded to 16 bytes in std140; only types that already
+// are can be arrays here, so float[4] must be written as Std140Vec4.
+template<typename T, size_t N>
+struct Std140Traits<T[N]>
+{
+    static_assert(Std140Traits<T>::size % 16 == 0,
+                  "std140 pads array elements to 16 bytes; use Std140Vec4 or Std140Mat4 elements");
+    static constexpr unsigned int alignment = 16;
+    static constexpr unsigned int size = (unsigned int)N * Std140Traits<T>::size;
+};
+
+// Member of a Std140Layout: where C++ put it and what std140 requires.
+struct Std140Member
+{
+    unsigned int offset;
+    unsigned int alignment;
+    unsigned int size;
+
+    template<typename Member>
+    static constexpr Std140Member Of(size_t offset)
+    {
+        return {(unsigned int)offset, Std140Traits<Member>::alignment, Std140Traits<Member>::size};
+    }
+};
+
+// Layout of a uniform block struct, checked at compile time; see UNIFORM_BLOCK.
+template<size_t N>
+struct Std140Layout
+{
+    std::array<Std140Member, N> members;
+    unsigned int size;
+
+    static constexpr size_t count = N;
+
+    // Every member sits at the offset std140 assigns it after the one
+    // before, which also catches members left out of the list.
+    constexpr bool IsStd140() const
+    {
+        unsigned int offset = 0;
+        for (size_t i = 0; i < N; i++)
+        {
+            unsigned int alignment = members[i].alignment;
+            offset = (offset + alignment - 1) / alignment * alignment;
+            if (members[i].offset != offset)
+                return false;
+            offset += members[i].size;
+        }
+        return (offset + 15) / 16 * 16 == size;
+    }
+};
+
+template<typename Block, typename... Members>
+constexpr Std140Layout<sizeof...(Members)> MakeStd140Layout(Members... members)
+{
+    static_assert(std::is_standard_layout_v<Block>, "uniform block structs must be standard layout");
+    static_assert(sizeof(Block) % 16 == 0, "pad uniform block structs to a multiple of 16 bytes");
+    return {{{members...}}, (unsigned int)sizeof(Block)};
+}
+
+// Maps a uniform block struct to its layout; specialise with UNIFORM_BLOCK.
+template<typename Block>
+struct UniformBlockOf;
+
+#define UNIFORM_MEMBER(Block, member) \
+    Std140Member::Of<decltype(Block::member)>(offsetof(Block, member))
+
+// At namespace scope, after the struct, listing every member in order:
+//
+//     struct FrameUniforms { Std140Mat4 viewProjection; Std140Vec4 color; float time; float pad[3]; };
+//     UNIFORM_BLOCK(FrameUniforms, UNIFORM_MEMBER(FrameUniforms, viewProjection),
+//                   UNIFORM_MEMBER(FrameUniforms, color), UNIFORM_MEMBER(FrameUniforms, time))
+//
+// matches "layout(std140) uniform FrameUniforms { mat4 viewProjection; vec4
+// color; float time; };". Trailing padding needs no entry; an array of the
+// struct is then a std140 array of the GLSL struct.
+#define UNIFORM_BLOCK(Block, ...) \
+    template<> \
+    struct UniformBlockOf<Block> \
+    { \
+        static constexpr auto value = MakeStd140Layout<Block>(__VA_ARGS__); \
+        static_assert(value.IsStd140(), #Block " does not match std140; reorder or pad its members"); \
+    };
@@ -0,0 +1,143 @@
+#include "UniformRing.h"
+#include "GLDebug.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include <algorithm>
+#include <iostream>
+
+UniformBindings::UniformBindings() : m_MaxBindings(0)
+{
+    GLCall(glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &m_MaxBindings));
+}
+
+UniformBindings& UniformBindings::Get()
+{
+    static UniformBindings bindings;
+    return bindings;
+}
+
+unsigned int UniformBindings::GetBinding(const std::string& blockName)
+{
+    auto it = m_Bindings.find(blockName);
+    if (it != m_Bindings.end())
+        return it->second;
+    if (m_Bindings.size() >= (size_t)m_MaxBindings)
+    {
+        std::cerr << "UniformBindings: no binding point left for " << blockName << " (" << m_MaxBindings
+                  << " in use)" << std::endl;
+        return GL_INVALID_INDEX;
+    }
+    unsigned int binding = (unsigned int)m_Bindings.size();
+    m_Bindings.emplace(blockName, binding);
+    return binding;
+}
+
+bool UniformBindings::Attach(unsigned int program, const std::string& blockName)
+{
+    unsigned int index;
+    GLCall(index = glGetUniformBlockIndex(program, blockName.c_str()));
+    if (index == GL_INVALID_INDEX)
+        return false;
+    unsigned int binding = GetBinding(blockName);
+    if (binding == GL_INVALID_INDEX)
+        return false;
+    GLCall(glUniformBlockBinding(program, index, binding));
+    return true;
+}
+
+UniformRing::UniformRing(unsigned int frameSize, unsigned int frameCount)
+    : m_FrameCount(std::min(std::max(frameCount, 1u), MAX_FRAMES)), m_Frame(0), m_Alignment(256), m_Used(0),
+      m_Uploaded(false), m_Fences{}
+{
+    int alignment = 0;
+    GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+    if (alignment > 0)
+        m_Alignment = (unsigned int)alignment;
+    // Regions start aligned too, so region base + push offset still is.
+    m_FrameSize = (frameSize + m_Alignment - 1) / m_Alignment * m_Alignment;
+    m_Staging.resize(m_FrameSize);
+
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)m_FrameSize * m_FrameCount, nullptr, GL_DYNAMIC_DRAW));
+}
+
+UniformRing::~UniformRing()
+{
+    for (GLsync& fence : m_Fences)
+        if (fence)
+            GLCall(glDeleteSync(fence));
+    GLDeletionQueue::Get().Delete(GLDeletionQueue::BUFFER, m_RendererID);
+}
+
+unsigned int UniformRing::Allocate(unsigned int size)
+{
+    unsigned int offset = (m_Used + m_Alignment - 1) / m_Alignment * m_Alignment;
+    if (size > m_FrameSize || offset > m_FrameSize - size)
+    {
+        m_Stats.overflows++;
+        return INVALID_OFFSET;
+    }
+    m_Used = offset + size;
+    return offset;
+}
+
+void UniformRing::Begin()
+{
+    if (m_Uploaded)
+    {
+        // The previous frame's draws have all been issued by now.
+        GLCall(m_Fences[m_Frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        m_Frame = (m_Frame + 1) % m_FrameCount;
+    }
+    m_Used = 0;
+    m_Uploaded = false;
+}
+
+void UniformRing::End()
+{
+    GLsync& fence = m_Fences[m_Frame];
+    if (fence)
+    {
+        GLenum result;
+        GLCall(result = glClientWaitSync(fence, 0, 0));
+        if (result == GL_TIMEOUT_EXPIRED)
+        {
+            m_Stats.stalls++;
+            do
+            {
+                GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+            } while (result == GL_TIMEOUT_EXPIRED);
+        }
+        GLCall(glDeleteSync(fence));
+        fence = nullptr;
+    }
+
+    if (m_Used > 0)
+    {
+        GLStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+        GLCall(glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)m_Frame * m_FrameSize, m_Used, m_Staging.data()));
+        m_Stats.uploads++;
+        m_Stats.bytes += m_Used;
+    }
+    m_Uploaded = true;
+}
+
+void UniformRing::Bind(unsigned int binding, unsigned int offset, unsigned int size)
+{
+    if (offset == INVALID_OFFSET || binding == GL_INVALID_INDEX)
+        return;
+    ASSERT(m_Uploaded);
+    // glBindBufferRange also sets the generic binding; keep the cache in step.
+    GLStateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+    GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_RendererID, (GLintptr)m_Frame * m_FrameSize + offset, size));
+    m_Stats.binds++;
+}
+
+void UniformRing::Report(std::ostream& out) const
+{
+    out << "UniformRing: " << m_Stats.blocks << " blocks in " << m_Stats.uploads << " uploads ("
+        << m_Stats.bytes << " bytes), " << m_Stats.binds << " range binds, " << m_Stats.stalls
+        << " stalls on the GPU, " << m_Stats.overflows << " pushes over the " << m_FrameSize << " byte frame"
+        << std::endl;
+}
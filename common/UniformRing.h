@@ -0,0 +1,128 @@
+#pragma once
+
+#include "glad/glad.h"
+#include "UniformBlock.h"
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Uniform block binding points, one per block name for every program.
+//
+// A block is attached to the same binding point in every program that
+// declares it, so data bound once reaches all of them and switching programs
+// needs no rebinding.
+class UniformBindings
+{
+    private:
+        std::unordered_map<std::string, unsigned int> m_Bindings;
+        int m_MaxBindings;
+
+        UniformBindings();
+
+    public:
+        static UniformBindings& Get();
+
+        // Assigned on first use; GL_INVALID_INDEX once every point is taken.
+        unsigned int GetBinding(const std::string& blockName);
+        // Points program's blockName block at its binding. False if the program
+        // has no such active block.
+        bool Attach(unsigned int program, const std::string& blockName);
+};
+
+// Per-frame uniform data for many objects, uploaded with one write.
+//
+// Blocks are pushed into a CPU staging copy during the frame; End writes it
+// into the frame's region of a ring of frameCount regions with a single
+// glBufferSubData, after waiting on that region's fence, and Begin fences
+// the previous frame's region. Every push starts at
+// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT so it can be bound with
+// glBindBufferRange on its own.
+//
+//     ring.Begin();
+//     unsigned int frame = ring.Push(frameUniforms);
+//     unsigned int objects = ring.Push(objectUniforms.data(), count);
+//     ring.End();
+//     ring.Bind<FrameUniforms>(UniformBindings::Get().GetBinding("FrameUniforms"), frame);
+//     ... draws ...
+class UniformRing
+{
+    public:
+        static constexpr unsigned int INVALID_OFFSET = ~0u;
+
+        struct Stats
+        {
+            unsigned long long blocks = 0;
+            unsigned long long uploads = 0;
+            unsigned long long bytes = 0;
+            unsigned long long binds = 0;
+            // Frames whose region was still in use by the GPU.
+            unsigned long long stalls = 0;
+            // Pushes dropped because the frame was full.
+            unsigned long long overflows = 0;
+        };
+
+    private:
+        static constexpr unsigned int MAX_FRAMES = 4;
+
+        unsigned int m_RendererID;
+        unsigned int m_FrameSize;
+        unsigned int m_FrameCount;
+        unsigned int m_Frame;
+        unsigned int m_Alignment;
+        std::vector<unsigned char> m_Staging;
+        unsigned int m_Used;
+        bool m_Uploaded;
+        GLsync m_Fences[MAX_FRAMES];
+        Stats m_Stats;
+
+        unsigned int Allocate(unsigned int size);
+
+    public:
+        // frameSize bytes of blocks per frame.
+        explicit UniformRing(unsigned int frameSize, unsigned int frameCount = 3);
+        ~UniformRing();
+
+        UniformRing(const UniformRing&) = delete;
+        UniformRing& operator=(const UniformRing&) = delete;
+
+        void Begin();
+        // Copies the block(s) into the staging data; returns the offset to bind,
+        // or INVALID_OFFSET when the frame is full.
+        template<typename Block>
+        unsigned int Push(const Block& block)
+        {
+            return Push(&block, 1);
+        }
+        template<typename Block>
+        unsigned int Push(const Block* blocks, unsigned int count)
+        {
+            static_assert(UniformBlockOf<Block>::value.IsStd140(), "declare the block with UNIFORM_BLOCK");
+            unsigned int size = (unsigned int)sizeof(Block) * count;
+            unsigned int offset = Allocate(size);
+            if (offset != INVALID_OFFSET)
+            {
+                std::memcpy(m_Staging.data() + offset, blocks, size);
+                m_Stats.blocks += count;
+            }
+            return offset;
+        }
+        // Uploads everything pushed since Begin.
+        void End();
+
+        // Binds count blocks at offset, from this frame's region, to binding.
+        void Bind(unsigned int binding, unsigned int offset, unsigned int size);
+        template<typename Block>
+        void Bind(unsigned int binding, unsigned int offset, unsigned int count = 1)
+        {
+            Bind(binding, offset, (unsigned int)sizeof(Block) * count);
+        }
+
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+        inline unsigned int GetAlignment() const { return m_Alignment; }
+        inline unsigned int GetFrameSize() const { return m_FrameSize; }
+        inline const Stats& GetStats() const { return m_Stats; }
+        void ResetStats() { m_Stats = Stats(); }
+        void Report(std::ostream& out) const;
+};
@@ -0,0 +1,84 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int workers)
+    : m_Job(nullptr), m_Count(0), m_Grain(1), m_Next(0), m_Active(0), m_Generation(0), m_Stop(false)
+{
+    for (unsigned int i = 0; i < workers; i++)
+        m_Threads.emplace_back(&WorkerPool::Run, this);
+}
+
+WorkerPool& WorkerPool::Get()
+{
+    static WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+    for (std::thread& thread : m_Threads)
+        thread.join();
+}
+
+void WorkerPool::Work(std::unique_lock<std::mutex>& lock)
+{
+    const std::function<void(size_t, size_t)>* job = m_Job;
+    while (m_Next < m_Count)
+    {
+        size_t begin = m_Next;
+        size_t end = std::min(begin + m_Grain, m_Count);
+        m_Next = end;
+        m_Active++;
+        lock.unlock();
+        (*job)(begin, end);
+        lock.lock();
+        m_Active--;
+    }
+    if (m_Active == 0)
+        m_Done.notify_all();
+}
+
+void WorkerPool::Run()
+{
+    unsigned long long seen = 0;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_Wake.wait(lock, [&] { return m_Stop || m_Generation != seen; });
+        if (m_Stop)
+            return;
+        seen = m_Generation;
+        Work(lock);
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& job)
+{
+    if (count == 0)
+        return;
+    grain = std::max(grain, (size_t)1);
+    if (m_Threads.empty() || count <= grain)
+    {
+        job(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submit(m_SubmitMutex);
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Job = &job;
+    m_Count = count;
+    m_Grain = grain;
+    m_Next = 0;
+    m_Generation++;
+    m_Wake.notify_all();
+
+    Work(lock);
+    m_Done.wait(lock, [&] { return m_Next >= m_Count && m_Active == 0; });
+    m_Job = nullptr;
+    m_Count = 0;
+}
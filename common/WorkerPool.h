@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent threads for data-parallel CPU work such as building draw
+// commands. No GL calls may be made from the jobs; only the context thread
+// has a current context.
+//
+//     WorkerPool::Get().ParallelFor(count, 1024, [&](size_t begin, size_t end) {
+//         for (size_t i = begin; i < end; i++) ...
+//     });
+class WorkerPool
+{
+    private:
+        std::vector<std::thread> m_Threads;
+        std::mutex m_Mutex;
+        std::condition_variable m_Wake;
+        std::condition_variable m_Done;
+        // Serialises ParallelFor callers.
+        std::mutex m_SubmitMutex;
+
+        const std::function<void(size_t, size_t)>* m_Job;
+        size_t m_Count;
+        size_t m_Grain;
+        size_t m_Next;
+        unsigned int m_Active;
+        unsigned long long m_Generation;
+        bool m_Stop;
+
+        explicit WorkerPool(unsigned int workers);
+        void Run();
+        // Takes chunks until the job is exhausted; called with m_Mutex held.
+        void Work(std::unique_lock<std::mutex>& lock);
+
+    public:
+        // hardware_concurrency - 1 workers; the caller is the last thread.
+        static WorkerPool& Get();
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        // Workers plus the calling thread.
+        inline unsigned int GetThreadCount() const { return (unsigned int)m_Threads.size() + 1; }
+
+        // Calls job(begin, end) over [0, count) in chunks of grain items on
+        // the workers and the calling thread; returns once every chunk ran.
+        void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& job);
+};
@@ -0,0 +1,77 @@
+// Measures the per-call cost of each GLCall error policy on the current
+// driver. All three expansions are compiled into the same binary so they run
+// against the same context.
+//
+//   glcall_bench [--iterations N] [--headless]
+#include "GLDebug.h"
+#include "GLContext.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    template<typename F>
+    double NanosecondsPerCall(int iterations, F&& body)
+    {
+        // One untimed pass so every mode starts from warm driver caches.
+        body(iterations / 10);
+        glFinish();
+        auto start = Clock::now();
+        body(iterations);
+        glFinish();
+        auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        return elapsed / iterations;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 1000000;
+    for (int i = 1; i + 1 < argc; i++)
+        if (std::strcmp(argv[i], "--iterations") == 0)
+            iterations = std::atoi(argv[++i]);
+
+    GLContextDesc desc;
+    desc.width = 64;
+    desc.height = 64;
+    desc.title = "glcall_bench";
+    desc.visible = false;
+    desc.debug = true;
+    std::unique_ptr<GLContext> context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+    if (!context || !context->LoadGL())
+        return -1;
+
+    unsigned int buffer;
+    glGenBuffers(1, &buffer);
+
+    // Alternate between two bindings so the driver cannot drop the call.
+    double off = NanosecondsPerCall(iterations, [&](int n) {
+        for (int i = 0; i < n; i++)
+            GLCALL_OFF(glBindBuffer(GL_ARRAY_BUFFER, (i & 1) ? buffer : 0));
+    });
+    double strict = NanosecondsPerCall(iterations, [&](int n) {
+        for (int i = 0; i < n; i++)
+            GLCALL_STRICT(glBindBuffer(GL_ARRAY_BUFFER, (i & 1) ? buffer : 0));
+    });
+
+    bool debugOutput = GLDebugInstallCallback();
+    double async = NanosecondsPerCall(iterations, [&](int n) {
+        for (int i = 0; i < n; i++)
+            GLCALL_ASYNC(glBindBuffer(GL_ARRAY_BUFFER, (i & 1) ? buffer : 0));
+    });
+
+    std::cout << "GLCall overhead, " << iterations << " x glBindBuffer\n";
+    std::cout << "  off    : " << off << " ns/call\n";
+    std::cout << "  async  : " << async << " ns/call" << (debugOutput ? "" : " (no KHR_debug, tag only)") << "\n";
+    std::cout << "  strict : " << strict << " ns/call\n";
+    std::cout << "  async overhead  : " << async - off << " ns/call\n";
+    std::cout << "  strict overhead : " << strict - off << " ns/call" << std::endl;
+
+    glDeleteBuffers(1, &buffer);
+    return 0;
+}
@@ -0,0 +1,223 @@
+// Per-object parameters for many small draws, set with glUniform4f per draw,
+// as a UniformRing range per object, or as arrays of blocks indexed by
+// gl_InstanceID. Both ring variants upload the whole frame in one write.
+//
+//   uniform_bench [--objects N] [--frames N] [--headless]
+#include "GLContext.h"
+#include "GLDebug.h"
+#include "GLStateCache.h"
+#include "UniformRing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+}
+
+struct ObjectUniforms
+{
+    Std140Vec4 offsetScale;
+    Std140Vec4 color;
+};
+UNIFORM_BLOCK(ObjectUniforms, UNIFORM_MEMBER(ObjectUniforms, offsetScale), UNIFORM_MEMBER(ObjectUniforms, color))
+
+namespace
+{
+    // 512 * 32 bytes is the 16 KB every GL 3.3 implementation allows per block.
+    constexpr unsigned int OBJECTS_PER_BLOCK = 512;
+
+    const char* UNIFORM_VERTEX_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) in vec2 position;\n"
+        "uniform vec4 u_OffsetScale;\n"
+        "uniform vec4 u_Color;\n"
+        "out vec4 v_Color;\n"
+        "void main() { v_Color = u_Color; gl_Position = vec4(position * u_OffsetScale.z + u_OffsetScale.xy, 0.0, 1.0); }\n";
+    const char* BLOCK_VERTEX_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) in vec2 position;\n"
+        "layout(std140) uniform Object { vec4 offsetScale; vec4 color; };\n"
+        "out vec4 v_Color;\n"
+        "void main() { v_Color = color; gl_Position = vec4(position * offsetScale.z + offsetScale.xy, 0.0, 1.0); }\n";
+    const char* ARRAY_VERTEX_SHADER =
+        "#version 330 core\n"
+        "layout(location = 0) in vec2 position;\n"
+        "struct ObjectUniforms { vec4 offsetScale; vec4 color; };\n"
+        "layout(std140) uniform Objects { ObjectUniforms objects[512]; };\n"
+        "out vec4 v_Color;\n"
+        "void main()\n"
+        "{\n"
+        "    ObjectUniforms object = objects[gl_InstanceID];\n"
+        "    v_Color = object.color;\n"
+        "    gl_Position = vec4(position * object.offsetScale.z + object.offsetScale.xy, 0.0, 1.0);\n"
+        "}\n";
+    const char* FRAGMENT_SHADER =
+        "#version 330 core\n"
+        "in vec4 v_Color;\n"
+        "layout(location = 0) out vec4 color;\n"
+        "void main() { color = v_Color; }\n";
+
+    unsigned int CompileProgram(const char* vertexSource)
+    {
+        unsigned int program = glCreateProgram();
+        const char* sources[] = {vertexSource, FRAGMENT_SHADER};
+        const unsigned int types[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+        for (int i = 0; i < 2; i++)
+        {
+            unsigned int shader = glCreateShader(types[i]);
+            GLCall(glShaderSource(shader, 1, &sources[i], nullptr));
+            GLCall(glCompileShader(shader));
+            GLCall(glAttachShader(program, shader));
+            GLCall(glDeleteShader(shader));
+        }
+        GLCall(glLinkProgram(program));
+        return program;
+    }
+
+    void Animate(std::vector<ObjectUniforms>& objects, int frame)
+    {
+        unsigned int side = (unsigned int)std::ceil(std::sqrt((double)objects.size()));
+        float cell = 2.0f / (float)std::max(side, 1u);
+        for (unsigned int i = 0; i < objects.size(); i++)
+        {
+            float phase = (float)frame * 0.05f + (float)i * 0.01f;
+            objects[i].offsetScale = {-1.0f + cell * ((float)(i % side) + 0.5f), -1.0f + cell * ((float)(i / side) + 0.5f),
+                                      cell * (0.6f + 0.2f * std::sin(phase)), 1.0f};
+            objects[i].color = {0.5f + 0.5f * std::sin(phase), 0.3f, 0.8f, 1.0f};
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int objectCount = 10000;
+    int frames = 60;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--objects") == 0)
+            objectCount = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[++i]);
+    }
+
+    GLContextDesc desc;
+    desc.width = 256;
+    desc.height = 256;
+    desc.title = "uniform_bench";
+    desc.visible = false;
+    desc.vsync = false;
+    std::unique_ptr<GLContext> context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+    if (!context || !context->LoadGL())
+        return -1;
+
+    GLStateCache& state = GLStateCache::Get();
+    unsigned int uniformProgram = CompileProgram(UNIFORM_VERTEX_SHADER);
+    unsigned int blockProgram = CompileProgram(BLOCK_VERTEX_SHADER);
+    unsigned int arrayProgram = CompileProgram(ARRAY_VERTEX_SHADER);
+    UniformBindings& bindings = UniformBindings::Get();
+    bindings.Attach(blockProgram, "Object");
+    bindings.Attach(arrayProgram, "Objects");
+    unsigned int objectBinding = bindings.GetBinding("Object");
+    unsigned int objectsBinding = bindings.GetBinding("Objects");
+    int offsetScaleLocation = glGetUniformLocation(uniformProgram, "u_OffsetScale");
+    int colorLocation = glGetUniformLocation(uniformProgram, "u_Color");
+
+    const float vertices[] = {-0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f};
+    const unsigned char indices[] = {0, 1, 2, 2, 3, 0};
+    unsigned int vao, buffers[2];
+    GLCall(glGenVertexArrays(1, &vao));
+    GLCall(glGenBuffers(2, buffers));
+    state.BindVertexArray(vao);
+    state.BindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    GLCall(glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW));
+    GLCall(glEnableVertexAttribArray(0));
+    GLCall(glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr));
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW));
+
+    std::vector<ObjectUniforms> objects(objectCount);
+    std::cout << objectCount << " objects, " << frames << " frames\n" << std::fixed << std::setprecision(3);
+
+    auto time = [&](const char* name, auto&& frame) {
+        double totalMs = 0.0;
+        for (int f = 0; f < frames; f++)
+        {
+            Animate(objects, f);
+            GLCall(glClear(GL_COLOR_BUFFER_BIT));
+            auto start = Clock::now();
+            frame();
+            totalMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            context->SwapBuffers();
+        }
+        glFinish();
+        std::cout << std::setw(16) << name << " : " << totalMs / frames << " ms/frame CPU" << std::endl;
+    };
+
+    time("glUniform4f", [&] {
+        state.UseProgram(uniformProgram);
+        for (const ObjectUniforms& object : objects)
+        {
+            GLCall(glUniform4fv(offsetScaleLocation, 1, &object.offsetScale.x));
+            GLCall(glUniform4fv(colorLocation, 1, &object.color.x));
+            GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, nullptr));
+        }
+    });
+
+    {
+        // Every push is padded to the offset alignment, usually 256 bytes.
+        UniformRing ring(objectCount * 256);
+        std::vector<unsigned int> offsets(objectCount);
+        time("range per object", [&] {
+            ring.Begin();
+            for (unsigned int i = 0; i < objectCount; i++)
+                offsets[i] = ring.Push(objects[i]);
+            ring.End();
+            state.UseProgram(blockProgram);
+            for (unsigned int i = 0; i < objectCount; i++)
+            {
+                ring.Bind<ObjectUniforms>(objectBinding, offsets[i]);
+                GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, nullptr));
+            }
+        });
+        ring.Report(std::cout);
+    }
+
+    {
+        // The last block is bound whole too; a range smaller than the block is
+        // undefined behaviour.
+        unsigned int blockCount = (objectCount + OBJECTS_PER_BLOCK - 1) / OBJECTS_PER_BLOCK;
+        UniformRing ring(blockCount * (OBJECTS_PER_BLOCK * (unsigned int)sizeof(ObjectUniforms) + 256));
+        std::vector<unsigned int> offsets;
+        time("array of blocks", [&] {
+            ring.Begin();
+            offsets.clear();
+            for (unsigned int first = 0; first < objectCount; first += OBJECTS_PER_BLOCK)
+                offsets.push_back(ring.Push(&objects[first], std::min(OBJECTS_PER_BLOCK, objectCount - first)));
+            ring.End();
+            state.UseProgram(arrayProgram);
+            for (unsigned int block = 0; block < offsets.size(); block++)
+            {
+                unsigned int count = std::min(OBJECTS_PER_BLOCK, objectCount - block * OBJECTS_PER_BLOCK);
+                ring.Bind<ObjectUniforms>(objectsBinding, offsets[block], OBJECTS_PER_BLOCK);
+                GLCall(glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_BYTE, nullptr, count));
+            }
+        });
+        ring.Report(std::cout);
+    }
+
+    GLCall(glDeleteVertexArrays(1, &vao));
+    GLCall(glDeleteBuffers(2, buffers));
+    GLCall(glDeleteProgram(uniformProgram));
+    GLCall(glDeleteProgram(blockProgram));
+    GLCall(glDeleteProgram(arrayProgram));
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Render-thread frame time while a mesh streams in every frame, uploaded
+// either synchronously with glBufferData or through AsyncUploader.
+//
+//   upload_bench [--mesh-mb N] [--frames N] [--headless]
+#include "AsyncUploader.h"
+#include "GLContext.h"
+#include "GLDebug.h"
+#include "GLStateCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Result
+    {
+        double meanMs;
+        double maxMs;
+    };
+
+    template<typename F>
+    Result MeasureFrames(GLContext& context, int frames, F&& frame)
+    {
+        std::vector<double> times;
+        for (int i = 0; i < frames; i++)
+        {
+            auto start = Clock::now();
+            GLCall(glClear(GL_COLOR_BUFFER_BIT));
+            frame();
+            context.SwapBuffers();
+            times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        double total = 0.0;
+        for (double time : times)
+            total += time;
+        return {total / times.size(), *std::max_element(times.begin(), times.end())};
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int meshMb = 16;
+    int frames = 60;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--mesh-mb") == 0)
+            meshMb = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0)
+            frames = std::atoi(argv[++i]);
+    }
+
+    GLContextDesc desc;
+    desc.width = 256;
+    desc.height = 256;
+    desc.title = "upload_bench";
+    desc.visible = false;
+    desc.vsync = false;
+    std::unique_ptr<GLContext> context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+    if (!context || !context->LoadGL())
+        return -1;
+
+    std::vector<unsigned char> mesh((size_t)meshMb * 1024 * 1024, 0x3f);
+
+    Result sync = MeasureFrames(*context, frames, [&] {
+        unsigned int buffer;
+        GLCall(glGenBuffers(1, &buffer));
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)mesh.size(), mesh.data(), GL_STATIC_DRAW));
+        GLCall(glDeleteBuffers(1, &buffer));
+    });
+    glFinish();
+    // The sync pass bound behind the cache's back.
+    GLStateCache::Get().Invalidate();
+
+    AsyncUploader uploader(*context);
+    Result async = MeasureFrames(*context, frames, [&] {
+        // The copy into the job is render-thread work and is counted.
+        uploader.Upload(mesh, [](unsigned int buffer) { GLCall(glDeleteBuffers(1, &buffer)); });
+        uploader.Poll();
+    });
+    uploader.Finish();
+
+    std::cout << frames << " frames, one " << meshMb << " MiB upload per frame\n";
+    std::cout << "  sync  : " << sync.meanMs << " ms mean, " << sync.maxMs << " ms max\n";
+    std::cout << "  async : " << async.meanMs << " ms mean, " << async.maxMs << " ms max"
+              << (uploader.IsAsync() ? "" : " (no shared context, ran synchronously)") << std::endl;
+    return 0;
+}
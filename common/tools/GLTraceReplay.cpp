@@ -0,0 +1,92 @@
+// Replays a trace written by GLTraceBegin/GLTraceEnd.
+//
+//   gltrace_replay <trace> [--null] [--headless] [--loops N]
+//
+// --null decodes without touching GL so the remaining time is the cost of
+// the call stream itself; otherwise the trace runs on a hidden window, or
+// on an offscreen EGL context with --headless.
+#include "GLTrace.h"
+#include "GLContext.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+    void PrintFrameTimes(const char* label, std::vector<double> ms)
+    {
+        if (ms.empty())
+            return;
+        std::sort(ms.begin(), ms.end());
+        double total = 0.0;
+        for (double value : ms) total += value;
+        std::cout << label << ": mean " << total / ms.size()
+                  << " ms, p50 " << ms[ms.size() / 2]
+                  << " ms, p95 " << ms[std::min(ms.size() - 1, ms.size() * 95 / 100)]
+                  << " ms, max " << ms.back() << " ms\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: gltrace_replay <trace> [--null] [--headless] [--loops N]" << std::endl;
+        return -1;
+    }
+
+    bool nullBackend = false;
+    int loops = 1;
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--null") == 0)
+            nullBackend = true;
+        else if (std::strcmp(argv[i], "--loops") == 0 && i + 1 < argc)
+            loops = std::max(1, std::atoi(argv[++i]));
+    }
+
+    std::unique_ptr<GLContext> context;
+    if (!nullBackend)
+    {
+        GLContextDesc desc;
+        desc.width = 640;
+        desc.height = 480;
+        desc.title = "gltrace_replay";
+        desc.visible = false;
+        desc.vsync = false;
+        context = GLContext::Create(GLContextDesc::FromArgs(argc, argv, desc));
+        if (!context || !context->LoadGL())
+            return -1;
+    }
+
+    for (int loop = 0; loop < loops; loop++)
+    {
+        // Fresh replayer per loop: the trace creates its own objects.
+        GLTraceReplayer replayer(nullBackend);
+        if (!replayer.Load(argv[1]))
+            return -1;
+
+        GLTraceReplayStats stats = replayer.Replay([&] {
+            if (context)
+            {
+                glFinish();
+                context->SwapBuffers();
+            }
+        });
+
+        std::cout << "loop " << loop << ": " << stats.commands << " commands, "
+                  << stats.frameMs.size() << " frames" << (nullBackend ? " (null backend)" : "") << "\n";
+        PrintFrameTimes("  replay  ", stats.frameMs);
+        PrintFrameTimes("  recorded", stats.recordedFrameMs);
+        if (loop == 0)
+        {
+            for (size_t f = 0; f < (size_t)GLTraceFunc::Count; f++)
+                if (stats.callsPerFunc[f])
+                    std::cout << "    " << GLTraceFuncName((GLTraceFunc)f) << ": " << stats.callsPerFunc[f] << "\n";
+        }
+    }
+
+    return 0;
+}
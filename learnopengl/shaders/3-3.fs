@@ -7,9 +7,15 @@ in vec2 TexCoord;
 // texture samplers
 uniform sampler2D texture1;
 uniform sampler2D texture2;
+// per-frame parameters, uploaded together as one uniform buffer range
+layout(std140) uniform FrameUniforms
+{
+	// weight of texture2, animated by the simulation thread
+	float mixValue;
+};
 
 void main()
 {
-	// linearly interpolate between both textures (80% container, 20% awesomeface)
-	FragColor = mix(texture(texture1, TexCoord), texture(texture2, vec2(TexCoord.x, TexCoord.y)), 0.2);
+	// linearly interpolate between both textures (around 80% container, 20% awesomeface)
+	FragColor = mix(texture(texture1, TexCoord), texture(texture2, vec2(TexCoord.x, TexCoord.y)), mixValue);
 }
\ No newline at end of file
@@ -1,16 +0,0 @@
-#include "Renderer.h"
-#include <iostream>
-
-void GLClearError()
-{
-    while (glGetError() != GL_NO_ERROR);
-}
-bool GLLogCall(const char* function, const char* file, int line)
-{
-    while(GLenum error = glGetError())
-    {
-        std::cout << "[OpenGL Error] (" <<  error << "): " << function << " " << file << ";" << line << std::endl; 
-        return false;
-    }
-    return true;
-}   
\ No newline at end of file
@@ -1,10 +1,4 @@
-#include "glad/glad.h"
+#pragma once
 
-#define ASSERT(x) if(!(x)) __debugbreak();
-#define GLCall(x) GLClearError();\
-    x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
-
-
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
+// GL error checking (GLCall/ASSERT) lives in common/GLDebug.h.
+#include "GLDebug.h"
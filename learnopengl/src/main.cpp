@@ -1,12 +1,21 @@
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
+#include <cmath>
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include <fstream>
 #include <malloc.h>
 #include <sstream>
 #include <string>
+#include <vector>
 #include "Renderer.h"
+#include "GLContext.h"
+#include "FrameBenchmark.h"
+#include "GpuProfiler.h"
+#include "GLStateCache.h"
+#include "GLDeletionQueue.h"
+#include "FramePipeline.h"
 #include "shader_s.h"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -18,6 +27,28 @@ struct ShaderProgramSource
     std::string FragmentSource;
 };
 
+// 每帧参数，与 3-3.fs 中的 FrameUniforms 块按 std140 布局一致(编译期检查)
+struct FrameUniforms
+{
+    float mixValue;
+    float pad[3];
+};
+UNIFORM_BLOCK(FrameUniforms, UNIFORM_MEMBER(FrameUniforms, mixValue))
+
+// 模拟线程交给渲染线程的一帧：uniform 值和可见的绘制列表，发布后只读
+struct FramePacket
+{
+    struct Draw
+    {
+        unsigned int vertexArray;
+        unsigned int indexCount;
+    };
+
+    FrameUniforms uniforms;
+    unsigned int textures[2];
+    std::vector<Draw> draws;
+};
+
 namespace{
     void processInput(GLFWwindow *window)
     {
@@ -79,35 +110,35 @@ namespace{
         return id;
     }
 }
-int main(){
-    // 初始化GLFW库
-    glfwInit();
-    // 设置OpenGL版本为3.3
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    // 设置使用OpenGL核心模式
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // 创建一个800x600像素的窗口
-    GLFWwindow* window = glfwCreateWindow(800, 600, "hellotriangle", nullptr, nullptr);
-    // 如果窗口创建失败，输出错误信息并退出程序
-    if(window == nullptr)
+int main(int argc, char** argv){
+    // 创建800x600的窗口(或 --headless 时的离屏上下文)，OpenGL 3.3 核心模式
+    GLContextDesc desc;
+    desc.width = 800;
+    desc.height = 600;
+    desc.title = "hellotriangle";
+    desc.debug = GL_DEBUG_POLICY == GL_DEBUG_POLICY_ASYNC;
+    // --frames N [--warmup M] [--json out.json] 以固定帧数运行基准测试
+    FrameBenchmark benchmark(FrameBenchmarkDesc::FromArgs(argc, argv, "hellotriangle"));
+    GLContextDesc contextDesc = GLContextDesc::FromArgs(argc, argv, desc);
+    if (benchmark.IsEnabled())
+        contextDesc.maxFrames = benchmark.GetTotalFrames();
+    std::unique_ptr<GLContext> context = GLContext::Create(contextDesc);
+    // context 最先创建，main 结束时最后销毁(窗口模式下同时终止GLFW库)
+    // 如果创建失败，退出程序
+    if(context == nullptr)
     {
-        std::cerr << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
         return -1;
     }
 
-    // 将窗口的上下文设置为当前线程的上下文
-    glfwMakeContextCurrent(window);
-    // 设置帧缓冲区大小回调函数
-    glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int, int)->void { glViewport(0,0,800,600);});
+    // 设置帧缓冲区大小回调函数(仅窗口模式)
+    if (GLFWwindow* window = context->GetWindow())
+        glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int, int)->void { glViewport(0,0,800,600);});
 
-    // 初始化GLAD库，如果失败，输出错误信息并退出程序
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD" << std::endl;
+    // 初始化GLAD库，如果失败，退出程序
+    if (!context->LoadGL()) {
         return -1;
     }
+    GLDebugInit();
 
     // 创建Shader对象
     Shader ourShader("../shaders/3-3.vs","../shaders/3-3.fs");
@@ -135,15 +166,18 @@ int main(){
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
 
+    // 所有绑定都经过状态缓存，重复绑定不会发给驱动
+    GLStateCache& state = GLStateCache::Get();
+
     // 绑定VAO对象
-    glBindVertexArray(VAO);
+    state.BindVertexArray(VAO);
 
     // 绑定VBO对象，并将顶点数据复制到缓冲区中
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    state.BindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     // 绑定EBO对象，并将索引数据复制到缓冲区中
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
     // 配置顶点属性指针
@@ -161,8 +195,8 @@ int main(){
     glGenTextures(1, &texture1);//纹理对象id
 
     // 绑定纹理对象到纹理单元0
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture1);//绑定id和纹理对象
+    state.ActiveTexture(0);
+    state.BindTexture(0, GL_TEXTURE_2D, texture1);//绑定id和纹理对象
 
     // 设置纹理参数
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);//设置样式环绕(wrap)方式,repeat是重复
@@ -191,8 +225,8 @@ int main(){
     // 生成第二个纹理对象
     glGenTextures(1, &texture2);//纹理对象id
 
-    // 绑定纹理对象到纹理单元2
-    glBindTexture(GL_TEXTURE_2D, texture2);//绑定id和纹理对象
+    // 绑定纹理对象到纹理单元0(设置参数用)
+    state.BindTexture(0, GL_TEXTURE_2D, texture2);//绑定id和纹理对象
 
     // 设置纹理参数
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);//设置样式环绕(wrap)方式,repeat是重复
@@ -221,44 +255,102 @@ int main(){
     ourShader.use();
     glUniform1i(glGetUniformLocation(ourShader.ID, "texture1"), 0);
     ourShader.setInt("texture2", 1);
-
-    // 主循环
-    while (!glfwWindowShouldClose(window)) 
+    // 采样器只能是普通 uniform；其余每帧参数走 uniform 缓冲，每帧一次上传
+    if (!ourShader.bindUniformBlock("FrameUniforms"))
+        std::cerr << "Shader has no FrameUniforms block" << std::endl;
+    unsigned int frameBinding = UniformBindings::Get().GetBinding("FrameUniforms");
     {
-        // 处理输入
-        processInput(window);
-
-        // 清除颜色缓冲区
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        // 绑定纹理对象
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-
-        // 使用Shader对象
-        ourShader.use();
+        UniformRing uniforms(sizeof(FrameUniforms));
+
+        // 模拟线程计算第 N 帧的同时，渲染线程提交第 N-1 帧；--frame-slots 3 为三缓冲
+        unsigned int frameSlots = 2;
+        for (int i = 1; i + 1 < argc; i++)
+            if (std::string(argv[i]) == "--frame-slots")
+                frameSlots = (unsigned int)std::stoi(argv[++i]);
+        FramePipeline<FramePacket> pipeline([&](FramePacket& packet, unsigned long long frame) {
+            packet.uniforms.mixValue = 0.2f + 0.15f * std::sin((float)frame * 0.02f);
+            packet.textures[0] = texture1;
+            packet.textures[1] = texture2;
+            packet.draws.clear();
+            packet.draws.push_back({VAO, 6});
+        }, frameSlots);
+
+        // GPU/CPU 分段计时
+        GpuProfiler profiler;
+
+        // 主循环
+        while (!context->ShouldClose()) 
+        {
+            // 处理输入(GLFW 只能在主线程调用)
+            if (GLFWwindow* window = context->GetWindow())
+                processInput(window);
 
-        // 绑定VAO对象并绘制三角形
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            benchmark.BeginFrame();
+            const FramePacket* packet = pipeline.Acquire();
+            profiler.BeginFrame();
+            {
+                GpuZone zone(profiler, "clear");
+                // 清除颜色缓冲区
+                glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+            {
+                GpuZone zone(profiler, "texture bind");
+                // 绑定纹理对象
+                state.BindTexture(0, GL_TEXTURE_2D, packet->textures[0]);
+                state.BindTexture(1, GL_TEXTURE_2D, packet->textures[1]);
+            }
+            {
+                GpuZone zone(profiler, "draw");
+                // 使用Shader对象
+                ourShader.use();
+                uniforms.Begin();
+                unsigned int frameOffset = uniforms.Push(packet->uniforms);
+                uniforms.End();
+                uniforms.Bind<FrameUniforms>(frameBinding, frameOffset);
+
+                // 绑定VAO对象并绘制三角形
+                for (const FramePacket::Draw& draw : packet->draws)
+                {
+                    state.BindVertexArray(draw.vertexArray);
+                    glDrawElements(GL_TRIANGLES, draw.indexCount, GL_UNSIGNED_INT, 0);
+                }
+            }
+            // 提交完毕，包交还给模拟线程
+            pipeline.Release();
+            profiler.EndFrame();
+
+            // 本帧释放的 GL 对象等 GPU 用完后再删除
+            GLDeletionQueue::Get().EndFrame();
+
+            // 交换缓冲区并处理事件
+            benchmark.BeginSwap();
+            context->SwapBuffers();
+            benchmark.EndFrame(profiler.GetLastFrameGpuMs());
+            context->PollEvents();
+        }
 
-        // 交换缓冲区并处理事件
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // 输出基准测试结果和各分段耗时
+        if (benchmark.IsEnabled())
+            benchmark.Finish(std::cout);
+        profiler.Report(std::cout);
+        state.Report(std::cout);
+        pipeline.Stop();
+        pipeline.Report(std::cout);
+        uniforms.Report(std::cout);
     }
+    // 上面的 uniform 缓冲已排入删除队列，趁上下文还在时释放
+    GLDeletionQueue::Get().Flush();
 
     // 删除VAO、VBO和EBO对象
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    state.OnDeleteVertexArray(VAO);
+    state.OnDeleteBuffer(VBO);
+    state.OnDeleteBuffer(EBO);
     // glDeleteProgram(ourShader.ID);
 
-    // 终止GLFW库
-    glfwTerminate();
-
     // 输出消息
     std::cout << "Hello, from hellotriangle!\n";
 
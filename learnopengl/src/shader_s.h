@@ -1,5 +1,7 @@
 #include <fstream>
 #include <glad/glad.h>
+#include "GLStateCache.h"
+#include "UniformRing.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -71,7 +73,13 @@ class Shader
 
     void use()
     {
-        glUseProgram(ID);
+        GLStateCache::Get().UseProgram(ID);
+    }
+
+    // 把 uniform 块接到该块名全局统一的绑定点上，没有这个块时返回 false
+    bool bindUniformBlock(const std::string &name) const
+    {
+        return UniformBindings::Get().Attach(ID, name);
     }
 
     void setBool(const std::string &name, bool value) const
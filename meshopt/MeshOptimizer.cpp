@@ -0,0 +1,324 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr unsigned int NONE = ~0u;
+
+    // FIFO cache simulated with timestamps: a vertex is cached while fewer
+    // than cacheSize misses happened since it was last transformed.
+    class CacheSimulator
+    {
+        private:
+            std::vector<unsigned int> m_Timestamps;
+            unsigned int m_Time;
+            unsigned int m_Size;
+
+        public:
+            CacheSimulator(unsigned int vertexCount, unsigned int cacheSize)
+                : m_Timestamps(vertexCount, 0), m_Time(cacheSize + 1), m_Size(cacheSize) {}
+
+            // Returns true on a miss.
+            bool Access(unsigned int vertex)
+            {
+                if (m_Time - m_Timestamps[vertex] <= m_Size)
+                    return false;
+                m_Timestamps[vertex] = m_Time++;
+                return true;
+            }
+
+            void Clear() { m_Time += m_Size + 1; }
+    };
+
+    // Triangles using each vertex, as offsets into one flat list.
+    struct Adjacency
+    {
+        std::vector<unsigned int> offsets;
+        std::vector<unsigned int> counts;
+        std::vector<unsigned int> triangles;
+
+        Adjacency(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount)
+            : offsets(vertexCount + 1, 0), counts(vertexCount, 0), triangles(indexCount)
+        {
+            for (unsigned int i = 0; i < indexCount; i++)
+                counts[indices[i]]++;
+            for (unsigned int v = 0; v < vertexCount; v++)
+                offsets[v + 1] = offsets[v] + counts[v];
+            std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+            for (unsigned int i = 0; i < indexCount; i++)
+                triangles[fill[indices[i]]++] = i / 3;
+        }
+    };
+
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    Vec3 LoadPosition(const float* positions, unsigned int stride, unsigned int vertex)
+    {
+        Vec3 p;
+        std::memcpy(&p, (const unsigned char*)positions + (size_t)vertex * stride, sizeof(p));
+        return p;
+    }
+}
+
+VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize)
+{
+    VertexCacheStats stats;
+    CacheSimulator cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+    unsigned int unique = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+    {
+        unsigned int v = indices[i];
+        if (cache.Access(v))
+            stats.transformed++;
+        if (!referenced[v])
+        {
+            referenced[v] = true;
+            unique++;
+        }
+    }
+    if (indexCount)
+        stats.acmr = (float)stats.transformed / (indexCount / 3);
+    if (unique)
+        stats.atvr = (float)stats.transformed / unique;
+    return stats;
+}
+
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+                         unsigned int cacheSize, std::vector<unsigned int>* clusters)
+{
+    Adjacency adjacency(indices, indexCount, vertexCount);
+    std::vector<unsigned int> live = adjacency.counts;
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(indexCount / 3, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    unsigned int time = cacheSize + 1;
+    unsigned int cursor = 0;
+    unsigned int written = 0;
+
+    if (clusters)
+        clusters->clear();
+
+    // Next vertex with triangles left: the most recently used from the
+    // dead-end stack, else the next in input order. Both restart cold.
+    auto skipDeadEnd = [&]() {
+        while (!deadEnd.empty())
+        {
+            unsigned int vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[vertex] > 0)
+                return vertex;
+        }
+        for (; cursor < vertexCount; cursor++)
+            if (live[cursor] > 0)
+                return cursor;
+        return NONE;
+    };
+
+    unsigned int fanning = skipDeadEnd();
+    if (clusters && fanning != NONE)
+        clusters->push_back(0);
+    while (fanning != NONE)
+    {
+        candidates.clear();
+        for (unsigned int a = adjacency.offsets[fanning]; a < adjacency.offsets[fanning + 1]; a++)
+        {
+            unsigned int triangle = adjacency.triangles[a];
+            if (emitted[triangle])
+                continue;
+            emitted[triangle] = true;
+            for (unsigned int corner = 0; corner < 3; corner++)
+            {
+                unsigned int v = indices[triangle * 3 + corner];
+                destination[written++] = v;
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+        }
+
+        // Prefer the oldest cached vertex whose remaining triangles still
+        // fit before it is evicted.
+        unsigned int next = NONE;
+        int bestPriority = -1;
+        for (unsigned int v : candidates)
+        {
+            if (live[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+                priority = (int)(time - cacheTime[v]);
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+        if (next == NONE)
+        {
+            next = skipDeadEnd();
+            if (clusters && next != NONE)
+                clusters->push_back(written);
+        }
+        fanning = next;
+    }
+}
+
+void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+                      const std::vector<unsigned int>& clusters, const float* positions, unsigned int vertexCount,
+                      unsigned int positionStride, unsigned int cacheSize, float threshold)
+{
+    if (clusters.empty() || indexCount == 0)
+    {
+        std::copy(indices, indices + indexCount, destination);
+        return;
+    }
+
+    // Split each cluster wherever the run so far is already within
+    // threshold of the whole cluster's ACMR; smaller clusters sort better.
+    std::vector<unsigned int> soft;
+    CacheSimulator cache(vertexCount, cacheSize);
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        unsigned int begin = clusters[c];
+        unsigned int end = c + 1 < clusters.size() ? clusters[c + 1] : indexCount;
+
+        cache.Clear();
+        unsigned int misses = 0;
+        for (unsigned int i = begin; i < end; i++)
+            misses += cache.Access(indices[i]);
+        float clusterAcmr = threshold * misses / ((end - begin) / 3);
+
+        soft.push_back(begin);
+        cache.Clear();
+        unsigned int runMisses = 0;
+        unsigned int runTriangles = 0;
+        for (unsigned int i = begin; i < end; i += 3)
+        {
+            runMisses += cache.Access(indices[i]) + cache.Access(indices[i + 1]) + cache.Access(indices[i + 2]);
+            runTriangles++;
+            if (i + 3 < end && (float)runMisses / runTriangles <= clusterAcmr)
+            {
+                soft.push_back(i + 3);
+                cache.Clear();
+                runMisses = 0;
+                runTriangles = 0;
+            }
+        }
+    }
+
+    Vec3 meshCentre = {0.0f, 0.0f, 0.0f};
+    for (unsigned int v = 0; v < vertexCount; v++)
+    {
+        Vec3 p = LoadPosition(positions, positionStride, v);
+        meshCentre.x += p.x;
+        meshCentre.y += p.y;
+        meshCentre.z += p.z;
+    }
+    if (vertexCount)
+    {
+        meshCentre.x /= vertexCount;
+        meshCentre.y /= vertexCount;
+        meshCentre.z /= vertexCount;
+    }
+
+    // Clusters far out along their own normal occlude the rest; draw them
+    // first. Centroid and normal are area weighted.
+    std::vector<float> keys(soft.size());
+    for (size_t c = 0; c < soft.size(); c++)
+    {
+        unsigned int begin = soft[c];
+        unsigned int end = c + 1 < soft.size() ? soft[c + 1] : indexCount;
+        Vec3 centroid = {0.0f, 0.0f, 0.0f};
+        Vec3 normal = {0.0f, 0.0f, 0.0f};
+        float area = 0.0f;
+        for (unsigned int i = begin; i < end; i += 3)
+        {
+            Vec3 a = LoadPosition(positions, positionStride, indices[i]);
+            Vec3 b = LoadPosition(positions, positionStride, indices[i + 1]);
+            Vec3 d = LoadPosition(positions, positionStride, indices[i + 2]);
+            Vec3 ab = {b.x - a.x, b.y - a.y, b.z - a.z};
+            Vec3 ad = {d.x - a.x, d.y - a.y, d.z - a.z};
+            Vec3 cross = {ab.y * ad.z - ab.z * ad.y, ab.z * ad.x - ab.x * ad.z, ab.x * ad.y - ab.y * ad.x};
+            float triangleArea = std::sqrt(cross.x * cross.x + cross.y * cross.y + cross.z * cross.z);
+            centroid.x += (a.x + b.x + d.x) / 3.0f * triangleArea;
+            centroid.y += (a.y + b.y + d.y) / 3.0f * triangleArea;
+            centroid.z += (a.z + b.z + d.z) / 3.0f * triangleArea;
+            normal.x += cross.x;
+            normal.y += cross.y;
+            normal.z += cross.z;
+            area += triangleArea;
+        }
+        float inverseArea = area > 0.0f ? 1.0f / area : 0.0f;
+        float normalLength = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        float inverseNormal = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+        keys[c] = (centroid.x * inverseArea - meshCentre.x) * normal.x * inverseNormal +
+                  (centroid.y * inverseArea - meshCentre.y) * normal.y * inverseNormal +
+                  (centroid.z * inverseArea - meshCentre.z) * normal.z * inverseNormal;
+    }
+
+    std::vector<unsigned int> order(soft.size());
+    for (unsigned int c = 0; c < order.size(); c++)
+        order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return keys[a] > keys[b]; });
+
+    unsigned int written = 0;
+    for (unsigned int c : order)
+    {
+        unsigned int begin = soft[c];
+        unsigned int end = c + 1 < soft.size() ? soft[c + 1] : indexCount;
+        std::copy(indices + begin, indices + end, destination + written);
+        written += end - begin;
+    }
+}
+
+unsigned int OptimizeVertexFetchRemap(unsigned int* remap, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount)
+{
+    std::fill(remap, remap + vertexCount, NONE);
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+        if (remap[indices[i]] == NONE)
+            remap[indices[i]] = next++;
+    return next;
+}
+
+void RemapIndices(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, const unsigned int* remap)
+{
+    for (unsigned int i = 0; i < indexCount; i++)
+        destination[i] = remap[indices[i]];
+}
+
+void RemapVertices(void* destination, const void* vertices, unsigned int vertexCount, unsigned int stride, const unsigned int* remap)
+{
+    for (unsigned int v = 0; v < vertexCount; v++)
+        if (remap[v] != NONE)
+            std::memcpy((unsigned char*)destination + (size_t)remap[v] * stride, (const unsigned char*)vertices + (size_t)v * stride, stride);
+}
+
+void OptimizeMesh(std::vector<unsigned int>& indices, std::vector<unsigned char>& vertices, unsigned int stride,
+                  unsigned int positionOffset, unsigned int cacheSize)
+{
+    unsigned int indexCount = (unsigned int)indices.size();
+    unsigned int vertexCount = (unsigned int)(vertices.size() / stride);
+
+    std::vector<unsigned int> cacheOrder(indexCount);
+    std::vector<unsigned int> clusters;
+    OptimizeVertexCache(cacheOrder.data(), indices.data(), indexCount, vertexCount, cacheSize, &clusters);
+    const float* positions = (const float*)(vertices.data() + positionOffset);
+    OptimizeOverdraw(indices.data(), cacheOrder.data(), indexCount, clusters, positions, vertexCount, stride, cacheSize);
+
+    std::vector<unsigned int> remap(vertexCount);
+    unsigned int kept = OptimizeVertexFetchRemap(remap.data(), indices.data(), indexCount, vertexCount);
+    RemapIndices(indices.data(), indices.data(), indexCount, remap.data());
+    std::vector<unsigned char> remapped((size_t)kept * stride);
+    RemapVertices(remapped.data(), vertices.data(), vertexCount, stride, remap.data());
+    vertices.swap(remapped);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+// CPU passes that reorder indexed triangle lists before they are uploaded
+// to an IndexBuffer/VertexBuffer. None of them changes what is drawn.
+//
+//   1. OptimizeVertexCache  reorders triangles so recently transformed
+//      vertices are reused (Tipsify, Sander et al. 2007).
+//   2. OptimizeOverdraw     reorders clusters of the result so outward
+//      facing parts of the mesh are drawn first.
+//   3. OptimizeVertexFetch  renumbers vertices in order of first use so
+//      vertex fetch walks memory linearly.
+//
+// OptimizeMesh runs all three. destination and indices may not alias
+// unless stated otherwise.
+
+struct VertexCacheStats
+{
+    unsigned int transformed = 0; // vertex shader invocations
+    // Average cache miss ratio: transformed vertices per triangle
+    // (0.5 is the ideal for large regular meshes, 3 the worst case).
+    float acmr = 0.0f;
+    // Average transform to vertex ratio: transformed vertices per referenced
+    // vertex (1 is ideal).
+    float atvr = 0.0f;
+};
+
+// Simulates a FIFO post-transform cache of cacheSize entries.
+VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+// clusters, if given, receives the first index of every run that started
+// from a cold cache; OptimizeOverdraw consumes it.
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+                         unsigned int cacheSize = 16, std::vector<unsigned int>* clusters = nullptr);
+
+// indices must be the output of OptimizeVertexCache with its clusters.
+// Clusters are split further while that costs at most threshold times
+// their ACMR, then sorted by how far they face away from the mesh centre.
+// positions point at the first vertex's float x, y, z; stride is in bytes.
+void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+                      const std::vector<unsigned int>& clusters, const float* positions, unsigned int vertexCount,
+                      unsigned int positionStride, unsigned int cacheSize = 16, float threshold = 1.05f);
+
+// Fills remap (vertexCount entries) with each vertex's new position, or ~0u
+// for vertices no index refers to, and returns the number of vertices kept.
+unsigned int OptimizeVertexFetchRemap(unsigned int* remap, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount);
+// destination may alias indices.
+void RemapIndices(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, const unsigned int* remap);
+void RemapVertices(void* destination, const void* vertices, unsigned int vertexCount, unsigned int stride, const unsigned int* remap);
+
+// All three passes in place; vertices shrink to the referenced ones.
+// positionOffset is the byte offset of the float3 position in a vertex.
+void OptimizeMesh(std::vector<unsigned int>& indices, std::vector<unsigned char>& vertices, unsigned int stride,
+                  unsigned int positionOffset = 0, unsigned int cacheSize = 16);
@@ -0,0 +1,146 @@
+// ACMR/ATVR of generated meshes before and after each optimization pass.
+//
+//   meshopt_bench [--grid N] [--sphere N] [--cache N]
+//
+// Triangles are shuffled first to mimic exporters that emit them in no
+// useful order.
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Mesh
+    {
+        std::string name;
+        std::vector<float> positions; // x, y, z per vertex
+        std::vector<unsigned int> indices;
+    };
+
+    Mesh MakeGrid(unsigned int n)
+    {
+        Mesh mesh;
+        mesh.name = "grid " + std::to_string(n) + "x" + std::to_string(n);
+        for (unsigned int y = 0; y <= n; y++)
+            for (unsigned int x = 0; x <= n; x++)
+                mesh.positions.insert(mesh.positions.end(), {(float)x, (float)y, 0.0f});
+        for (unsigned int y = 0; y < n; y++)
+            for (unsigned int x = 0; x < n; x++)
+            {
+                unsigned int i = y * (n + 1) + x;
+                mesh.indices.insert(mesh.indices.end(), {i, i + 1, i + n + 2, i + n + 2, i + n + 1, i});
+            }
+        return mesh;
+    }
+
+    Mesh MakeSphere(unsigned int n)
+    {
+        Mesh mesh;
+        mesh.name = "sphere " + std::to_string(n);
+        const float pi = 3.14159265f;
+        for (unsigned int ring = 0; ring <= n; ring++)
+            for (unsigned int segment = 0; segment <= 2 * n; segment++)
+            {
+                float theta = pi * ring / n;
+                float phi = pi * segment / n;
+                mesh.positions.insert(mesh.positions.end(),
+                    {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)});
+            }
+        unsigned int row = 2 * n + 1;
+        for (unsigned int ring = 0; ring < n; ring++)
+            for (unsigned int segment = 0; segment < 2 * n; segment++)
+            {
+                unsigned int i = ring * row + segment;
+                mesh.indices.insert(mesh.indices.end(), {i, i + row, i + 1, i + 1, i + row, i + row + 1});
+            }
+        return mesh;
+    }
+
+    void ShuffleTriangles(std::vector<unsigned int>& indices)
+    {
+        std::mt19937 random(42);
+        unsigned int triangles = (unsigned int)indices.size() / 3;
+        for (unsigned int t = triangles - 1; t > 0; t--)
+        {
+            unsigned int other = random() % (t + 1);
+            for (unsigned int c = 0; c < 3; c++)
+                std::swap(indices[t * 3 + c], indices[other * 3 + c]);
+        }
+    }
+
+    void Print(const char* stage, const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize, double ms)
+    {
+        VertexCacheStats stats = AnalyzeVertexCache(indices.data(), (unsigned int)indices.size(), vertexCount, cacheSize);
+        std::cout << "  " << std::left << std::setw(12) << stage << std::right
+                  << " ACMR " << std::setw(6) << stats.acmr << "  ATVR " << std::setw(6) << stats.atvr;
+        if (ms >= 0.0)
+            std::cout << "  " << ms << " ms";
+        std::cout << "\n";
+    }
+
+    double Since(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    void Run(Mesh mesh, unsigned int cacheSize)
+    {
+        unsigned int vertexCount = (unsigned int)mesh.positions.size() / 3;
+        unsigned int indexCount = (unsigned int)mesh.indices.size();
+        std::cout << mesh.name << ": " << vertexCount << " vertices, " << indexCount / 3 << " triangles, cache " << cacheSize << "\n";
+
+        Print("generated", mesh.indices, vertexCount, cacheSize, -1.0);
+        ShuffleTriangles(mesh.indices);
+        Print("shuffled", mesh.indices, vertexCount, cacheSize, -1.0);
+
+        std::vector<unsigned int> cacheOrder(indexCount);
+        std::vector<unsigned int> clusters;
+        auto start = Clock::now();
+        OptimizeVertexCache(cacheOrder.data(), mesh.indices.data(), indexCount, vertexCount, cacheSize, &clusters);
+        Print("vertexcache", cacheOrder, vertexCount, cacheSize, Since(start));
+
+        std::vector<unsigned int> overdraw(indexCount);
+        start = Clock::now();
+        OptimizeOverdraw(overdraw.data(), cacheOrder.data(), indexCount, clusters, mesh.positions.data(), vertexCount,
+                         3 * sizeof(float), cacheSize);
+        Print("overdraw", overdraw, vertexCount, cacheSize, Since(start));
+
+        std::vector<unsigned int> remap(vertexCount);
+        start = Clock::now();
+        OptimizeVertexFetchRemap(remap.data(), overdraw.data(), indexCount, vertexCount);
+        RemapIndices(overdraw.data(), overdraw.data(), indexCount, remap.data());
+        Print("vertexfetch", overdraw, vertexCount, cacheSize, Since(start));
+        std::cout << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int grid = 300;
+    unsigned int sphere = 200;
+    unsigned int cacheSize = 16;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--grid") == 0)
+            grid = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--sphere") == 0)
+            sphere = (unsigned int)std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--cache") == 0)
+            cacheSize = (unsigned int)std::atoi(argv[++i]);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    Run(MakeGrid(grid), cacheSize);
+    Run(MakeSphere(sphere), cacheSize);
+    return 0;
+}
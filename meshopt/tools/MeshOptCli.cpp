@@ -0,0 +1,126 @@
+// Optimizes the triangle and vertex order of a Wavefront OBJ mesh.
+//
+//   meshopt <input.obj> [output.obj] [--cache N]
+//
+// Reads positions and faces only (polygons are fanned into triangles,
+// texture/normal references are dropped) and prints ACMR/ATVR before and
+// after. Without an output path nothing is written.
+#include "MeshOptimizer.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    bool LoadObj(const char* path, std::vector<float>& positions, std::vector<unsigned int>& indices)
+    {
+        std::ifstream stream(path);
+        if (!stream)
+        {
+            std::cerr << "Failed to open " << path << std::endl;
+            return false;
+        }
+
+        std::string line;
+        std::vector<unsigned int> face;
+        while (std::getline(stream, line))
+        {
+            std::istringstream ss(line);
+            std::string type;
+            ss >> type;
+            if (type == "v")
+            {
+                float x = 0.0f, y = 0.0f, z = 0.0f;
+                ss >> x >> y >> z;
+                positions.insert(positions.end(), {x, y, z});
+            }
+            else if (type == "f")
+            {
+                face.clear();
+                std::string corner;
+                while (ss >> corner)
+                {
+                    // "v", "v/vt", "v//vn" or "v/vt/vn"; negative is relative.
+                    long index = std::strtol(corner.c_str(), nullptr, 10);
+                    long vertexCount = (long)positions.size() / 3;
+                    index = index < 0 ? vertexCount + index : index - 1;
+                    if (index < 0 || index >= vertexCount)
+                    {
+                        std::cerr << "Bad face index in: " << line << std::endl;
+                        return false;
+                    }
+                    face.push_back((unsigned int)index);
+                }
+                for (size_t i = 2; i < face.size(); i++)
+                    indices.insert(indices.end(), {face[0], face[i - 1], face[i]});
+            }
+        }
+        return true;
+    }
+
+    bool SaveObj(const char* path, const std::vector<unsigned char>& vertices, const std::vector<unsigned int>& indices)
+    {
+        std::ofstream stream(path);
+        if (!stream)
+        {
+            std::cerr << "Failed to write " << path << std::endl;
+            return false;
+        }
+        const float* positions = (const float*)vertices.data();
+        for (size_t v = 0; v < vertices.size() / (3 * sizeof(float)); v++)
+            stream << "v " << positions[v * 3] << ' ' << positions[v * 3 + 1] << ' ' << positions[v * 3 + 2] << '\n';
+        for (size_t i = 0; i < indices.size(); i += 3)
+            stream << "f " << indices[i] + 1 << ' ' << indices[i + 1] + 1 << ' ' << indices[i + 2] + 1 << '\n';
+        return true;
+    }
+
+    void Print(const char* stage, const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize)
+    {
+        VertexCacheStats stats = AnalyzeVertexCache(indices.data(), (unsigned int)indices.size(), vertexCount, cacheSize);
+        std::cout << stage << ": ACMR " << stats.acmr << ", ATVR " << stats.atvr << "\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const char* input = nullptr;
+    const char* output = nullptr;
+    unsigned int cacheSize = 16;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+            cacheSize = (unsigned int)std::atoi(argv[++i]);
+        else if (!input)
+            input = argv[i];
+        else if (!output)
+            output = argv[i];
+    }
+    if (!input)
+    {
+        std::cerr << "usage: meshopt <input.obj> [output.obj] [--cache N]" << std::endl;
+        return 1;
+    }
+
+    std::vector<float> positions;
+    std::vector<unsigned int> indices;
+    if (!LoadObj(input, positions, indices))
+        return 1;
+
+    unsigned int vertexCount = (unsigned int)positions.size() / 3;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << input << ": " << vertexCount << " vertices, " << indices.size() / 3 << " triangles\n";
+    Print("before", indices, vertexCount, cacheSize);
+
+    std::vector<unsigned char> vertices((const unsigned char*)positions.data(), (const unsigned char*)(positions.data() + positions.size()));
+    OptimizeMesh(indices, vertices, 3 * sizeof(float), 0, cacheSize);
+    Print("after ", indices, (unsigned int)(vertices.size() / (3 * sizeof(float))), cacheSize);
+
+    if (output && !SaveObj(output, vertices, indices))
+        return 1;
+    return 0;
+}